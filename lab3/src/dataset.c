@@ -0,0 +1,134 @@
+#include "dataset.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static size_t ElementSize(enum ElementType type) {
+  return type == ELEMENT_INT64 ? sizeof(int64_t) : sizeof(int32_t);
+}
+
+int OpenDataset(const char *path, int flags, struct Dataset *dataset) {
+  memset(dataset, 0, sizeof(*dataset));
+
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    fprintf(stderr, "%s: %s\n", path, strerror(errno));
+    return -1;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1 || st.st_size == 0) {
+    fprintf(stderr, "%s: empty or unreadable file\n", path);
+    close(fd);
+    return -1;
+  }
+
+  int mmap_flags = MAP_SHARED;
+  if (flags & DATASET_POPULATE) mmap_flags |= MAP_POPULATE;
+  void *map = mmap(NULL, st.st_size, PROT_READ, mmap_flags, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    fprintf(stderr, "%s: mmap failed: %s\n", path, strerror(errno));
+    return -1;
+  }
+  if (flags & DATASET_SEQUENTIAL) madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+  dataset->map = map;
+  dataset->map_size = st.st_size;
+
+  const struct DatasetHeader *header = (const struct DatasetHeader *)map;
+  if ((size_t)st.st_size >= sizeof(*header) &&
+      header->magic == DATASET_MAGIC) {
+    size_t element_size = ElementSize(header->element_type);
+    if (header->version != DATASET_VERSION ||
+        (header->element_type != ELEMENT_INT32 &&
+         header->element_type != ELEMENT_INT64) ||
+        header->data_offset % element_size != 0 ||
+        header->data_offset > (uint64_t)st.st_size ||
+        header->count > (st.st_size - header->data_offset) / element_size) {
+      fprintf(stderr, "%s: corrupted dataset header\n", path);
+      CloseDataset(dataset);
+      return -1;
+    }
+    dataset->type = header->element_type;
+    dataset->count = header->count;
+    dataset->data = (char *)map + header->data_offset;
+
+    if (header->zone_count != 0) {
+      uint64_t zones_bytes =
+          (uint64_t)header->zone_count * sizeof(struct ZoneSummary);
+      if (header->zone_size == 0 ||
+          header->zone_offset % sizeof(uint32_t) != 0 ||
+          header->zone_offset > (uint64_t)st.st_size ||
+          zones_bytes > st.st_size - header->zone_offset ||
+          (header->count + header->zone_size - 1) / header->zone_size !=
+              header->zone_count) {
+        fprintf(stderr, "%s: corrupted zone map\n", path);
+        CloseDataset(dataset);
+        return -1;
+      }
+      dataset->zones =
+          (const struct ZoneSummary *)((char *)map + header->zone_offset);
+      dataset->zone_size = header->zone_size;
+      dataset->zone_count = header->zone_count;
+    }
+  } else {
+    dataset->type = ELEMENT_INT32;
+    dataset->count = st.st_size / sizeof(int32_t);
+    dataset->data = map;
+  }
+  return 0;
+}
+
+void CloseDataset(struct Dataset *dataset) {
+  if (dataset->map != NULL) munmap(dataset->map, dataset->map_size);
+  memset(dataset, 0, sizeof(*dataset));
+}
+
+int WriteDataset(const char *path, const int *array, uint64_t count, int raw,
+                 const struct ZoneSummary *zones, uint32_t zone_size,
+                 uint32_t zone_count) {
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    fprintf(stderr, "%s: %s\n", path, strerror(errno));
+    return -1;
+  }
+
+  if (!raw) {
+    struct DatasetHeader header = {0};
+    header.magic = DATASET_MAGIC;
+    header.version = DATASET_VERSION;
+    header.element_type = ELEMENT_INT32;
+    header.count = count;
+    header.data_offset = sizeof(header);
+    if (zones != NULL) {
+      // Сводки выравниваем по 8 байт после элементов
+      header.zone_offset =
+          (header.data_offset + count * sizeof(int) + 7) & ~(uint64_t)7;
+      header.zone_size = zone_size;
+      header.zone_count = zone_count;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+  }
+  size_t written = fwrite(array, sizeof(int), count, file);
+  bool ok = written == count;
+  if (!raw && zones != NULL && ok) {
+    static const char padding[8] = {0};
+    size_t pad = (8 - (count * sizeof(int)) % 8) % 8;
+    ok = fwrite(padding, 1, pad, file) == pad &&
+         fwrite(zones, sizeof(struct ZoneSummary), zone_count, file) ==
+             zone_count;
+  }
+  if (fclose(file) != 0 || !ok) {
+    fprintf(stderr, "%s: write failed\n", path);
+    return -1;
+  }
+  return 0;
+}
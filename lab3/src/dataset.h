@@ -0,0 +1,66 @@
+#ifndef DATASET_H
+#define DATASET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Бинарный формат набора данных: необязательный заголовок и сразу за ним
+// элементы в порядке байтов машины. Файл без заголовка считается сырым
+// массивом int32.
+#define DATASET_MAGIC 0x53444d4du  // "MMDS"
+#define DATASET_VERSION 1
+
+enum ElementType { ELEMENT_INT32 = 1, ELEMENT_INT64 = 2 };
+
+// Сводка зоны (блока из zone_size элементов) для пропуска блоков при
+// сканировании. Если в заголовке zone_count != 0, массив сводок лежит в
+// файле по смещению zone_offset, после элементов.
+struct ZoneSummary {
+  int32_t min;
+  int32_t max;
+  uint32_t count;
+  uint32_t reserved;
+};
+
+struct DatasetHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t element_type;
+  uint32_t flags;
+  uint64_t count;
+  uint64_t data_offset;
+  uint64_t zone_offset;
+  uint32_t zone_size;
+  uint32_t zone_count;
+  uint64_t reserved[2];
+};
+
+// Флаги открытия
+#define DATASET_POPULATE 1    // MAP_POPULATE: заранее подтянуть все страницы
+#define DATASET_SEQUENTIAL 2  // MADV_SEQUENTIAL: агрессивный readahead
+
+// Файл, отображенный в память только для чтения (MAP_SHARED): дочерние
+// процессы после fork() читают те же страницы page cache без копирования
+struct Dataset {
+  void *map;
+  size_t map_size;
+  void *data;
+  uint64_t count;
+  enum ElementType type;
+  // Сводки зон из файла или NULL, если файл их не содержит
+  const struct ZoneSummary *zones;
+  uint32_t zone_size;
+  uint32_t zone_count;
+};
+
+// Возвращает 0 или -1 (сообщение об ошибке уже напечатано)
+int OpenDataset(const char *path, int flags, struct Dataset *dataset);
+void CloseDataset(struct Dataset *dataset);
+
+// Записывает массив int32 с заголовком (raw == 0) или без него. Если zones
+// не NULL, сводки зон сохраняются в файл вслед за элементами.
+int WriteDataset(const char *path, const int *array, uint64_t count, int raw,
+                 const struct ZoneSummary *zones, uint32_t zone_size,
+                 uint32_t zone_count);
+
+#endif
@@ -1,17 +1,167 @@
 #include "find_min_max.h"
 
 #include <limits.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 
-struct MinMax GetMinMax(int *array, unsigned int begin, unsigned int end) {
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FIND_MIN_MAX_X86 1
+#endif
+
+typedef struct MinMax (*MinMaxKernel)(int *array, size_t begin,
+                                      size_t end);
+
+static struct MinMax GetMinMaxScalar(int *array, size_t begin,
+                                     size_t end) {
   struct MinMax min_max;
   min_max.min = INT_MAX;
   min_max.max = INT_MIN;
 
-  for (int i = begin; i < end; i++) {
-  	if (array[i] < min_max.min)
-		min_max.min = array[i];
-	if (array[i] > min_max.max)
-		min_max.max = array[i];
+  for (size_t i = begin; i < end; i++) {
+    // Без ветвлений: компилятор превращает это в cmov
+    min_max.min = array[i] < min_max.min ? array[i] : min_max.min;
+    min_max.max = array[i] > min_max.max ? array[i] : min_max.max;
   }
   return min_max;
 }
+
+#ifdef FIND_MIN_MAX_X86
+
+// Хвост, не кратный ширине вектора, досчитываем скалярно
+static struct MinMax MergeTail(struct MinMax min_max, int *array,
+                               size_t begin, size_t end) {
+  struct MinMax tail = GetMinMaxScalar(array, begin, end);
+  if (tail.min < min_max.min) min_max.min = tail.min;
+  if (tail.max > min_max.max) min_max.max = tail.max;
+  return min_max;
+}
+
+__attribute__((target("sse4.1")))
+static struct MinMax GetMinMaxSse41(int *array, size_t begin,
+                                    size_t end) {
+  // Два независимых аккумулятора, чтобы не упираться в латентность pmin/pmax
+  __m128i vmin0 = _mm_set1_epi32(INT_MAX), vmin1 = vmin0;
+  __m128i vmax0 = _mm_set1_epi32(INT_MIN), vmax1 = vmax0;
+
+  size_t i = begin;
+  for (; end - i >= 8; i += 8) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(array + i));
+    __m128i b = _mm_loadu_si128((const __m128i *)(array + i + 4));
+    vmin0 = _mm_min_epi32(vmin0, a);
+    vmax0 = _mm_max_epi32(vmax0, a);
+    vmin1 = _mm_min_epi32(vmin1, b);
+    vmax1 = _mm_max_epi32(vmax1, b);
+  }
+  __m128i vmin = _mm_min_epi32(vmin0, vmin1);
+  __m128i vmax = _mm_max_epi32(vmax0, vmax1);
+
+  vmin = _mm_min_epi32(vmin, _mm_shuffle_epi32(vmin, _MM_SHUFFLE(1, 0, 3, 2)));
+  vmin = _mm_min_epi32(vmin, _mm_shuffle_epi32(vmin, _MM_SHUFFLE(2, 3, 0, 1)));
+  vmax = _mm_max_epi32(vmax, _mm_shuffle_epi32(vmax, _MM_SHUFFLE(1, 0, 3, 2)));
+  vmax = _mm_max_epi32(vmax, _mm_shuffle_epi32(vmax, _MM_SHUFFLE(2, 3, 0, 1)));
+
+  struct MinMax min_max;
+  min_max.min = _mm_cvtsi128_si32(vmin);
+  min_max.max = _mm_cvtsi128_si32(vmax);
+  return MergeTail(min_max, array, i, end);
+}
+
+__attribute__((target("avx2")))
+static struct MinMax GetMinMaxAvx2(int *array, size_t begin,
+                                   size_t end) {
+  __m256i vmin0 = _mm256_set1_epi32(INT_MAX), vmin1 = vmin0;
+  __m256i vmax0 = _mm256_set1_epi32(INT_MIN), vmax1 = vmax0;
+
+  size_t i = begin;
+  for (; end - i >= 16; i += 16) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(array + i));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(array + i + 8));
+    vmin0 = _mm256_min_epi32(vmin0, a);
+    vmax0 = _mm256_max_epi32(vmax0, a);
+    vmin1 = _mm256_min_epi32(vmin1, b);
+    vmax1 = _mm256_max_epi32(vmax1, b);
+  }
+  vmin0 = _mm256_min_epi32(vmin0, vmin1);
+  vmax0 = _mm256_max_epi32(vmax0, vmax1);
+
+  __m128i vmin = _mm_min_epi32(_mm256_castsi256_si128(vmin0),
+                               _mm256_extracti128_si256(vmin0, 1));
+  __m128i vmax = _mm_max_epi32(_mm256_castsi256_si128(vmax0),
+                               _mm256_extracti128_si256(vmax0, 1));
+  vmin = _mm_min_epi32(vmin, _mm_shuffle_epi32(vmin, _MM_SHUFFLE(1, 0, 3, 2)));
+  vmin = _mm_min_epi32(vmin, _mm_shuffle_epi32(vmin, _MM_SHUFFLE(2, 3, 0, 1)));
+  vmax = _mm_max_epi32(vmax, _mm_shuffle_epi32(vmax, _MM_SHUFFLE(1, 0, 3, 2)));
+  vmax = _mm_max_epi32(vmax, _mm_shuffle_epi32(vmax, _MM_SHUFFLE(2, 3, 0, 1)));
+
+  struct MinMax min_max;
+  min_max.min = _mm_cvtsi128_si32(vmin);
+  min_max.max = _mm_cvtsi128_si32(vmax);
+  return MergeTail(min_max, array, i, end);
+}
+
+__attribute__((target("avx512f")))
+static struct MinMax GetMinMaxAvx512(int *array, size_t begin,
+                                     size_t end) {
+  __m512i vmin0 = _mm512_set1_epi32(INT_MAX), vmin1 = vmin0;
+  __m512i vmax0 = _mm512_set1_epi32(INT_MIN), vmax1 = vmax0;
+
+  size_t i = begin;
+  for (; end - i >= 32; i += 32) {
+    __m512i a = _mm512_loadu_si512((const void *)(array + i));
+    __m512i b = _mm512_loadu_si512((const void *)(array + i + 16));
+    vmin0 = _mm512_min_epi32(vmin0, a);
+    vmax0 = _mm512_max_epi32(vmax0, a);
+    vmin1 = _mm512_min_epi32(vmin1, b);
+    vmax1 = _mm512_max_epi32(vmax1, b);
+  }
+
+  struct MinMax min_max;
+  min_max.min = _mm512_reduce_min_epi32(_mm512_min_epi32(vmin0, vmin1));
+  min_max.max = _mm512_reduce_max_epi32(_mm512_max_epi32(vmax0, vmax1));
+  return MergeTail(min_max, array, i, end);
+}
+
+#endif
+
+static MinMaxKernel kernel = GetMinMaxScalar;
+static const char *kernel_name = "scalar";
+
+// Выбираем ядро один раз при загрузке программы, до fork() и pthread_create(),
+// так что дочерние процессы и потоки наследуют уже готовый указатель.
+// Переменная окружения MIN_MAX_KERNEL позволяет принудительно выбрать ядро
+// (scalar, sse4.1, avx2, avx512) для сравнения производительности.
+__attribute__((constructor))
+static void SelectGetMinMaxKernel(void) {
+  const char *forced = getenv("MIN_MAX_KERNEL");
+  if (forced != NULL && strcmp(forced, "scalar") == 0) return;
+
+#ifdef FIND_MIN_MAX_X86
+  __builtin_cpu_init();
+  bool any = forced == NULL;
+  if (__builtin_cpu_supports("avx512f") &&
+      (any || strcmp(forced, "avx512") == 0)) {
+    kernel = GetMinMaxAvx512;
+    kernel_name = "avx512";
+  } else if (__builtin_cpu_supports("avx2") &&
+             (any || strcmp(forced, "avx2") == 0)) {
+    kernel = GetMinMaxAvx2;
+    kernel_name = "avx2";
+  } else if (__builtin_cpu_supports("sse4.1") &&
+             (any || strcmp(forced, "sse4.1") == 0)) {
+    kernel = GetMinMaxSse41;
+    kernel_name = "sse4.1";
+  }
+#endif
+}
+
+const char *GetMinMaxKernelName(void) { return kernel_name; }
+
+struct MinMax GetMinMax(int *array, size_t begin, size_t end) {
+  if (begin >= end) {
+    struct MinMax empty = {INT_MAX, INT_MIN};
+    return empty;
+  }
+  return kernel(array, begin, end);
+}
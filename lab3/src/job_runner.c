@@ -0,0 +1,370 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <getopt.h>
+
+#include "timing.h"
+
+#define JOB_PATH_SIZE 256
+#define JOB_OUTPUT_SIZE 256
+
+// Задание: "seed size" или "--input file" для sequential_min_max
+struct Job {
+    int seed;
+    int array_size;
+    char input[JOB_PATH_SIZE];
+    int cpu;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    int status;
+    bool parsed;
+    int min;
+    int max;
+};
+
+// Слот одновременного запуска: процесс и неблокирующий пайп его stdout
+struct Slot {
+    int job;  // -1 - слот свободен
+    pid_t pid;
+    int fd;
+    int cpu;
+    char output[JOB_OUTPUT_SIZE];
+    size_t length;
+};
+
+// Строки файла заданий: "seed size" или "input file"; # - комментарий
+static int LoadJobs(const char *path, struct Job **jobs, int *count) {
+    FILE *file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    int capacity = 16;
+    *jobs = malloc(capacity * sizeof(struct Job));
+    *count = 0;
+    char line[JOB_PATH_SIZE + 32];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line_number++;
+        char *text = line + strspn(line, " \t");
+        if (*text == '#' || *text == '\n' || *text == '\0') continue;
+        if (*count == capacity) {
+            capacity *= 2;
+            *jobs = realloc(*jobs, capacity * sizeof(struct Job));
+        }
+        struct Job *job = &(*jobs)[*count];
+        memset(job, 0, sizeof(*job));
+        if (sscanf(text, "input %255s", job->input) == 1) {
+            (*count)++;
+        } else if (sscanf(text, "%d %d", &job->seed, &job->array_size) == 2 &&
+                   job->seed > 0 && job->array_size > 0) {
+            (*count)++;
+        } else {
+            fprintf(stderr, "%s:%d: expected \"seed size\" or \"input file\"\n",
+                    path, line_number);
+            if (file != stdin) fclose(file);
+            return -1;
+        }
+    }
+    if (file != stdin) fclose(file);
+    return 0;
+}
+
+// Разрешенные процессу CPU по порядку; задания закрепляются по кругу
+static int AllowedCpus(int *cpus) {
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == -1) return 0;
+    int count = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &set)) cpus[count++] = cpu;
+    }
+    return count;
+}
+
+// Запускает задание в слоте: fork, закрепление на CPU, stdout в пайп, exec
+static int StartJob(struct Slot *slot, struct Job *job, int index,
+                    const char *program, int epoll_fd) {
+    int pipe_fds[2];
+    if (pipe(pipe_fds) == -1) {
+        perror("pipe failed");
+        return -1;
+    }
+    // Концы пайпа не должны утекать в задания соседних слотов: чужой
+    // открытый конец на запись не дал бы увидеть EOF
+    fcntl(pipe_fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(pipe_fds[1], F_SETFD, FD_CLOEXEC);
+
+    char seed[16], size[16];
+    char *args[4] = {(char *)program, NULL, NULL, NULL};
+    if (job->input[0] != '\0') {
+        args[1] = "--input";
+        args[2] = job->input;
+    } else {
+        snprintf(seed, sizeof(seed), "%d", job->seed);
+        snprintf(size, sizeof(size), "%d", job->array_size);
+        args[1] = seed;
+        args[2] = size;
+    }
+
+    job->start_ns = MonotonicNs();
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (slot->cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(slot->cpu, &set);
+            sched_setaffinity(0, sizeof(set), &set);
+        }
+        dup2(pipe_fds[1], STDOUT_FILENO);
+        execv(program, args);
+        perror("execv failed");
+        _exit(127);
+    }
+    close(pipe_fds[1]);
+    if (pid == -1) {
+        perror("fork failed");
+        close(pipe_fds[0]);
+        return -1;
+    }
+
+    fcntl(pipe_fds[0], F_SETFL, fcntl(pipe_fds[0], F_GETFL) | O_NONBLOCK);
+    struct epoll_event event = {.events = EPOLLIN};
+    event.data.ptr = slot;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pipe_fds[0], &event);
+
+    slot->job = index;
+    slot->pid = pid;
+    slot->fd = pipe_fds[0];
+    slot->length = 0;
+    job->cpu = slot->cpu;
+    return 0;
+}
+
+// Берет в слот очередные задания, пока одно не запустится: задание, которое
+// не удалось запустить, не должно оставлять слот пустым. false - задания
+// кончились
+static bool FillSlot(struct Slot *slot, struct Job *jobs, int job_count,
+                     int *next_job, const char *program, int epoll_fd,
+                     int *failed) {
+    while (*next_job < job_count) {
+        int index = (*next_job)++;
+        if (StartJob(slot, &jobs[index], index, program, epoll_fd) == 0) {
+            return true;
+        }
+        (*failed)++;
+        jobs[index].status = -1;
+    }
+    return false;
+}
+
+// Дочитывает пайп; true - задание закрыло stdout и пожато
+static bool DrainSlot(struct Slot *slot, struct Job *jobs, int epoll_fd) {
+    char chunk[4096];
+    while (true) {
+        ssize_t got = read(slot->fd, chunk, sizeof(chunk));
+        if (got > 0) {
+            // Лишнее сверх буфера отбрасывается: нужны только min и max
+            size_t room = sizeof(slot->output) - 1 - slot->length;
+            size_t keep = (size_t)got < room ? (size_t)got : room;
+            memcpy(slot->output + slot->length, chunk, keep);
+            slot->length += keep;
+            continue;
+        }
+        if (got == -1 && errno == EINTR) continue;
+        if (got == -1 && errno == EAGAIN) return false;
+        break;
+    }
+
+    // EOF или ошибка чтения: процесс завершается, пожинаем его
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, slot->fd, NULL);
+    close(slot->fd);
+    struct Job *job = &jobs[slot->job];
+    int status;
+    waitpid(slot->pid, &status, 0);
+    job->end_ns = MonotonicNs();
+    job->status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+
+    slot->output[slot->length] = '\0';
+    char *min_line = strstr(slot->output, "min: ");
+    char *max_line = strstr(slot->output, "max: ");
+    job->parsed = min_line != NULL && max_line != NULL &&
+                  sscanf(min_line, "min: %d", &job->min) == 1 &&
+                  sscanf(max_line, "max: %d", &job->max) == 1;
+    slot->job = -1;
+    return true;
+}
+
+// Пакетный запуск sequential_min_max: до concurrency процессов
+// одновременно, выводы собираются через неблокирующие пайпы в цикле epoll,
+// освободившийся слот сразу получает следующее задание
+int main(int argc, char **argv) {
+    const char *jobs_path = NULL;
+    const char *program = "./sequential_min_max";
+    int concurrency = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    bool pin = false;
+    enum TimingFormat timing = TIMING_NONE;
+
+    static struct option options[] = {{"jobs", required_argument, 0, 0},
+                                      {"concurrency", required_argument, 0, 0},
+                                      {"program", required_argument, 0, 0},
+                                      {"pin", no_argument, 0, 0},
+                                      {"timing", required_argument, 0, 0},
+                                      {0, 0, 0, 0}};
+
+    while (true) {
+        int option_index = 0;
+        int c = getopt_long(argc, argv, "", options, &option_index);
+
+        if (c == -1) break;
+
+        switch (c) {
+            case 0:
+                switch (option_index) {
+                    case 0:
+                        jobs_path = optarg;
+                        break;
+                    case 1:
+                        concurrency = atoi(optarg);
+                        if (concurrency <= 0) {
+                            printf("Concurrency must be a positive number\n");
+                            return 1;
+                        }
+                        break;
+                    case 2:
+                        program = optarg;
+                        break;
+                    case 3:
+                        pin = true;
+                        break;
+                    case 4:
+                        if (ParseTimingFormat(optarg, &timing) == -1) {
+                            printf("Timing format must be none, text or json\n");
+                            return 1;
+                        }
+                        break;
+                }
+                break;
+            case '?':
+                break;
+            default:
+                printf("getopt returned character code 0%o?\n", c);
+        }
+    }
+
+    if (jobs_path == NULL) {
+        printf("Usage: %s --jobs \"file\"|- [--concurrency \"num\"] [--pin] [--program \"path\"] [--timing text|json]\n",
+               argv[0]);
+        printf("Job file lines: \"seed array_size\" or \"input file.bin\"\n");
+        return 1;
+    }
+
+    struct Job *jobs;
+    int job_count;
+    if (LoadJobs(jobs_path, &jobs, &job_count) == -1) return 1;
+    if (job_count == 0) {
+        printf("No jobs\n");
+        free(jobs);
+        return 0;
+    }
+    if (concurrency > job_count) concurrency = job_count;
+
+    int cpus[CPU_SETSIZE];
+    int cpu_count = pin ? AllowedCpus(cpus) : 0;
+    struct Slot *slots = malloc(concurrency * sizeof(struct Slot));
+    for (int i = 0; i < concurrency; i++) {
+        slots[i].job = -1;
+        slots[i].cpu = cpu_count > 0 ? cpus[i % cpu_count] : -1;
+    }
+
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1) {
+        perror("epoll_create1 failed");
+        return 1;
+    }
+
+    struct Timeline timeline;
+    InitTimeline(&timeline);
+    int next_job = 0, running = 0, failed = 0;
+    for (int i = 0; i < concurrency; i++) {
+        if (FillSlot(&slots[i], jobs, job_count, &next_job, program, epoll_fd,
+                     &failed)) {
+            running++;
+        }
+    }
+
+    struct epoll_event events[64];
+    while (running > 0) {
+        int ready = epoll_wait(epoll_fd, events, 64, -1);
+        if (ready == -1) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait failed");
+            break;
+        }
+        for (int e = 0; e < ready; e++) {
+            struct Slot *slot = events[e].data.ptr;
+            if (!DrainSlot(slot, jobs, epoll_fd)) continue;
+            running--;
+            // Без простоя: слот сразу берет следующее задание
+            if (FillSlot(slot, jobs, job_count, &next_job, program, epoll_fd,
+                         &failed)) {
+                running++;
+            }
+        }
+    }
+    double wall_ms = (MonotonicNs() - timeline.origin_ns) / 1e6;
+    close(epoll_fd);
+
+    double busy_ms = 0;
+    for (int i = 0; i < job_count; i++) {
+        struct Job *job = &jobs[i];
+        char name[JOB_PATH_SIZE + 16];
+        if (job->input[0] != '\0') {
+            snprintf(name, sizeof(name), "input %s", job->input);
+        } else {
+            snprintf(name, sizeof(name), "seed %d size %d", job->seed, job->array_size);
+        }
+        if (job->status == -1) {
+            printf("Job %d (%s): not started\n", i, name);
+            continue;
+        }
+        double latency_ms = (job->end_ns - job->start_ns) / 1e6;
+        busy_ms += latency_ms;
+        AddSpan(&timeline, "job", i, job->start_ns, job->end_ns);
+        if (job->status != 0 || !job->parsed) {
+            if (job->status == 0) job->status = -1;
+            failed++;
+            printf("Job %d (%s): failed with status %d, %f ms\n", i, name,
+                   job->status, latency_ms);
+            continue;
+        }
+        printf("Job %d (%s): min %d max %d, %f ms", i, name, job->min, job->max,
+               latency_ms);
+        if (job->cpu >= 0) printf(", cpu %d", job->cpu);
+        printf("\n");
+    }
+
+    printf("Jobs: %d done, %d failed, concurrency %d%s\n", job_count - failed,
+           failed, concurrency, pin ? ", pinned" : "");
+    printf("Elapsed time: %f ms\n", wall_ms);
+    printf("Throughput: %.2f jobs/s\n", job_count / (wall_ms / 1e3));
+    // Доля времени слотов, занятая заданиями: 100% - без простоев
+    printf("Slot utilization: %.1f%%\n", 100.0 * busy_ms / (wall_ms * concurrency));
+    PrintTimeline(&timeline, timing, stdout);
+    FreeTimeline(&timeline);
+
+    free(slots);
+    free(jobs);
+    return failed > 0 ? 1 : 0;
+}
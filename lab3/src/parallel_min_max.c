@@ -6,13 +6,13 @@
 #include <string.h>
 #include <unistd.h>
 
-#include <sys/time.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 
 #include <getopt.h>
 
 #include "find_min_max.h"
+#include "timing.h"
 #include "utils.h"
 
 int main(int argc, char **argv) {
@@ -20,6 +20,7 @@ int main(int argc, char **argv) {
     int array_size = -1;
     int pnum = -1;
     bool with_files = false;
+    enum TimingFormat timing = TIMING_NONE;
 
     while (true) {
         int current_optind = optind ? optind : 1;
@@ -28,6 +29,7 @@ int main(int argc, char **argv) {
                                           {"array_size", required_argument, 0, 0},
                                           {"pnum", required_argument, 0, 0},
                                           {"by_files", no_argument, 0, 'f'},
+                                          {"timing", required_argument, 0, 0},
                                           {0, 0, 0, 0}};
 
         int option_index = 0;
@@ -62,6 +64,12 @@ int main(int argc, char **argv) {
                     case 3:
                         with_files = true;
                         break;
+                    case 4:
+                        if (ParseTimingFormat(optarg, &timing) == -1) {
+                            printf("Timing format must be none, text or json\n");
+                            return 1;
+                        }
+                        break;
 
                     default:
                         printf("Index %d is out of options\n", option_index);
@@ -85,7 +93,7 @@ int main(int argc, char **argv) {
     }
 
     if (seed == -1 || array_size == -1 || pnum == -1) {
-        printf("Usage: %s --seed \"num\" --array_size \"num\" --pnum \"num\" [--by_files]\n",
+        printf("Usage: %s --seed \"num\" --array_size \"num\" --pnum \"num\" [--by_files] [--timing text|json]\n",
                argv[0]);
         return 1;
     }
@@ -114,10 +122,11 @@ int main(int argc, char **argv) {
         }
     }
 
-    struct timeval start_time;
-    gettimeofday(&start_time, NULL);
+    struct Timeline timeline;
+    InitTimeline(&timeline);
 
     // Создаем дочерние процессы
+    int spawn_span = BeginSpan(&timeline, "spawn", SPAN_NO_WORKER);
     for (int i = 0; i < pnum; i++) {
         pid_t child_pid = fork();
         if (child_pid >= 0) {
@@ -130,25 +139,29 @@ int main(int argc, char **argv) {
                 int start = i * chunk_size;
                 int end = (i == pnum - 1) ? array_size : start + chunk_size;
                 
-                int local_min = INT_MAX;
-                int local_max = INT_MIN;
-                
-                for (int j = start; j < end; j++) {
-                    if (array[j] < local_min) local_min = array[j];
-                    if (array[j] > local_max) local_max = array[j];
-                }
+                // Вместе с результатом передаем границы вычисления, чтобы
+                // родитель положил их на свою шкалу времени
+                uint64_t compute_start = MonotonicNs();
+                struct MinMax local = GetMinMax(array, start, end);
+                uint64_t compute_end = MonotonicNs();
+                int local_min = local.min;
+                int local_max = local.max;
                 
                 if (with_files) {
                     FILE *file = fopen(filenames[i], "w");
                     if (file) {
-                        fprintf(file, "%d %d", local_min, local_max);
+                        fprintf(file, "%d %d %llu %llu", local_min, local_max,
+                                (unsigned long long)compute_start,
+                                (unsigned long long)compute_end);
                         fclose(file);
                     }
                 } else {
                     close(pipefds[2*i]);
                     FILE *stream = fdopen(pipefds[2*i + 1], "w");
                     if (stream) {
-                        fprintf(stream, "%d %d", local_min, local_max);
+                        fprintf(stream, "%d %d %llu %llu", local_min, local_max,
+                                (unsigned long long)compute_start,
+                                (unsigned long long)compute_end);
                         fclose(stream);
                     }
                     close(pipefds[2*i + 1]);
@@ -169,6 +182,9 @@ int main(int argc, char **argv) {
         }
     }
 
+    EndSpan(&timeline, spawn_span);
+
+    int wait_span = BeginSpan(&timeline, "wait", SPAN_NO_WORKER);
     while (active_child_processes > 0) {
 	  int status;
 	  pid_t finished_pid = wait(&status);  
@@ -178,19 +194,26 @@ int main(int argc, char **argv) {
 	  }
 	  active_child_processes -= 1;
     }
+    EndSpan(&timeline, wait_span);
 	
     struct MinMax min_max;
     min_max.min = INT_MAX;
     min_max.max = INT_MIN;
 
+    struct MinMax *results = malloc(pnum * sizeof(struct MinMax));
+    unsigned long long *computed = malloc(2 * pnum * sizeof(unsigned long long));
+    int transfer_span = BeginSpan(&timeline, "transfer", SPAN_NO_WORKER);
     for (int i = 0; i < pnum; i++) {
         int min = INT_MAX;
         int max = INT_MIN;
+        unsigned long long *bounds = computed + 2*i;
+        bounds[0] = bounds[1] = 0;
 
         if (with_files) {
             FILE *file = fopen(filenames[i], "r");
             if (file) {
-                fscanf(file, "%d %d", &min, &max);
+                fscanf(file, "%d %d %llu %llu", &min, &max, &bounds[0],
+                       &bounds[1]);
                 fclose(file);
                 remove(filenames[i]);
             }
@@ -198,27 +221,41 @@ int main(int argc, char **argv) {
             close(pipefds[2*i + 1]);
             FILE *stream = fdopen(pipefds[2*i], "r");
             if (stream) {
-                fscanf(stream, "%d %d", &min, &max);
+                fscanf(stream, "%d %d %llu %llu", &min, &max, &bounds[0],
+                       &bounds[1]);
                 fclose(stream);
             }
             close(pipefds[2*i]);
         }
 
-        if (min < min_max.min) min_max.min = min;
-        if (max > min_max.max) min_max.max = max;
+        results[i].min = min;
+        results[i].max = max;
     }
+    EndSpan(&timeline, transfer_span);
 
-    struct timeval finish_time;
-    gettimeofday(&finish_time, NULL);
+    int aggregate_span = BeginSpan(&timeline, "aggregate", SPAN_NO_WORKER);
+    for (int i = 0; i < pnum; i++) {
+        if (results[i].min < min_max.min) min_max.min = results[i].min;
+        if (results[i].max > min_max.max) min_max.max = results[i].max;
+    }
+    EndSpan(&timeline, aggregate_span);
 
-    double elapsed_time = (finish_time.tv_sec - start_time.tv_sec) * 1000.0;
-    elapsed_time += (finish_time.tv_usec - start_time.tv_usec) / 1000.0;
+    double elapsed_time = (MonotonicNs() - timeline.origin_ns) / 1e6;
+    for (int i = 0; i < pnum; i++) {
+        if (computed[2*i + 1] != 0) {
+            AddSpan(&timeline, "compute", i, computed[2*i], computed[2*i + 1]);
+        }
+    }
 
     free(array);
+    free(results);
+    free(computed);
 
     printf("Min: %d\n", min_max.min);
     printf("Max: %d\n", min_max.max);
     printf("Elapsed time: %fms\n", elapsed_time);
+    PrintTimeline(&timeline, timing, stdout);
+    FreeTimeline(&timeline);
     fflush(NULL);
     return 0;
 }
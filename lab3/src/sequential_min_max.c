@@ -1,12 +1,54 @@
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "dataset.h"
 #include "find_min_max.h"
+#include "timing.h"
 #include "utils.h"
 
 int main(int argc, char **argv) {
+  // Необязательный хвост "--timing text|json" печатает фазы прогона
+  enum TimingFormat timing = TIMING_NONE;
+  if (argc >= 5 && strcmp(argv[argc - 2], "--timing") == 0) {
+    if (ParseTimingFormat(argv[argc - 1], &timing) == -1) {
+      printf("timing format must be none, text or json\n");
+      return 1;
+    }
+    argc -= 2;
+  }
+  struct Timeline timeline;
+  InitTimeline(&timeline);
+
+  // Массив из бинарного файла, отображенного в память
+  if (argc == 3 && strcmp(argv[1], "--input") == 0) {
+    struct Dataset dataset;
+    int load_span = BeginSpan(&timeline, "load", SPAN_NO_WORKER);
+    if (OpenDataset(argv[2], DATASET_SEQUENTIAL, &dataset) == -1) return 1;
+    EndSpan(&timeline, load_span);
+    if (dataset.type != ELEMENT_INT32 || dataset.count == 0) {
+      printf("input must hold int32 elements\n");
+      CloseDataset(&dataset);
+      return 1;
+    }
+
+    int compute_span = BeginSpan(&timeline, "compute", 0);
+    struct MinMax min_max =
+        GetMinMax((int *)dataset.data, 0, (size_t)dataset.count);
+    EndSpan(&timeline, compute_span);
+    CloseDataset(&dataset);
+
+    printf("min: %d\n", min_max.min);
+    printf("max: %d\n", min_max.max);
+    PrintTimeline(&timeline, timing, stdout);
+    FreeTimeline(&timeline);
+    return 0;
+  }
+
   if (argc != 3) {
-    printf("Usage: %s seed arraysize\n", argv[0]);
+    printf("Usage: %s seed arraysize [--timing text|json]\n", argv[0]);
+    printf("       %s --input file.bin [--timing text|json]\n", argv[0]);
     return 1;
   }
 
@@ -22,13 +64,20 @@ int main(int argc, char **argv) {
     return 1;
   }
 
+  int generate_span = BeginSpan(&timeline, "generate", SPAN_NO_WORKER);
   int *array = malloc(array_size * sizeof(int));
   GenerateArray(array, array_size, seed);
+  EndSpan(&timeline, generate_span);
+
+  int compute_span = BeginSpan(&timeline, "compute", 0);
   struct MinMax min_max = GetMinMax(array, 0, array_size);
+  EndSpan(&timeline, compute_span);
   free(array);
 
   printf("min: %d\n", min_max.min);
   printf("max: %d\n", min_max.max);
+  PrintTimeline(&timeline, timing, stdout);
+  FreeTimeline(&timeline);
 
   return 0;
 }
@@ -0,0 +1,117 @@
+#include "timing.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TIMELINE_INITIAL_CAPACITY 16
+
+uint64_t MonotonicNs(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+void InitTimeline(struct Timeline *timeline) {
+  timeline->origin_ns = MonotonicNs();
+  timeline->spans = NULL;
+  timeline->count = 0;
+  timeline->capacity = 0;
+}
+
+void FreeTimeline(struct Timeline *timeline) {
+  free(timeline->spans);
+  timeline->spans = NULL;
+  timeline->count = 0;
+  timeline->capacity = 0;
+}
+
+void AddSpan(struct Timeline *timeline, const char *name, int worker,
+             uint64_t start_ns, uint64_t end_ns) {
+  if (timeline->count == timeline->capacity) {
+    int capacity = timeline->capacity ? 2 * timeline->capacity
+                                      : TIMELINE_INITIAL_CAPACITY;
+    struct Span *spans = realloc(timeline->spans, capacity * sizeof(struct Span));
+    if (spans == NULL) return;
+    timeline->spans = spans;
+    timeline->capacity = capacity;
+  }
+  struct Span *span = &timeline->spans[timeline->count++];
+  strncpy(span->name, name, SPAN_NAME_SIZE - 1);
+  span->name[SPAN_NAME_SIZE - 1] = '\0';
+  span->worker = worker;
+  span->start_ns = start_ns;
+  span->end_ns = end_ns;
+}
+
+int BeginSpan(struct Timeline *timeline, const char *name, int worker) {
+  uint64_t now = MonotonicNs();
+  AddSpan(timeline, name, worker, now, now);
+  return timeline->count - 1;
+}
+
+void EndSpan(struct Timeline *timeline, int span) {
+  if (span >= 0 && span < timeline->count) {
+    timeline->spans[span].end_ns = MonotonicNs();
+  }
+}
+
+double SpanMs(const struct Timeline *timeline, int span) {
+  if (span < 0 || span >= timeline->count) return 0;
+  const struct Span *s = &timeline->spans[span];
+  return (s->end_ns - s->start_ns) / 1e6;
+}
+
+double TotalSpanMs(const struct Timeline *timeline, const char *name) {
+  double total = 0;
+  for (int i = 0; i < timeline->count; i++) {
+    if (strcmp(timeline->spans[i].name, name) == 0) total += SpanMs(timeline, i);
+  }
+  return total;
+}
+
+int ParseTimingFormat(const char *name, enum TimingFormat *format) {
+  if (strcmp(name, "text") == 0) {
+    *format = TIMING_TEXT;
+  } else if (strcmp(name, "json") == 0) {
+    *format = TIMING_JSON;
+  } else if (strcmp(name, "none") == 0) {
+    *format = TIMING_NONE;
+  } else {
+    return -1;
+  }
+  return 0;
+}
+
+// Смещение от начала шкалы; отметки до него (чужие часы не бывают раньше,
+// но на всякий случай) обрезаются до нуля
+static double OffsetMs(const struct Timeline *timeline, uint64_t ns) {
+  return ns > timeline->origin_ns ? (ns - timeline->origin_ns) / 1e6 : 0;
+}
+
+void PrintTimeline(const struct Timeline *timeline, enum TimingFormat format,
+                   FILE *out) {
+  if (format == TIMING_TEXT) {
+    fprintf(out, "%-12s %6s %12s %12s\n", "span", "worker", "start ms",
+            "duration ms");
+    for (int i = 0; i < timeline->count; i++) {
+      const struct Span *span = &timeline->spans[i];
+      char worker[16] = "-";
+      if (span->worker != SPAN_NO_WORKER) {
+        snprintf(worker, sizeof(worker), "%d", span->worker);
+      }
+      fprintf(out, "%-12s %6s %12.3f %12.3f\n", span->name, worker,
+              OffsetMs(timeline, span->start_ns), SpanMs(timeline, i));
+    }
+  } else if (format == TIMING_JSON) {
+    fprintf(out, "{\"spans\": [");
+    for (int i = 0; i < timeline->count; i++) {
+      const struct Span *span = &timeline->spans[i];
+      fprintf(out, "%s{\"name\": \"%s\", \"worker\": %d, \"start_ms\": %.6f, "
+                   "\"duration_ms\": %.6f}",
+              i ? ", " : "", span->name, span->worker,
+              OffsetMs(timeline, span->start_ns), SpanMs(timeline, i));
+    }
+    fprintf(out, "]}\n");
+  }
+}
@@ -0,0 +1,54 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Именованные интервалы (spawn, compute, transfer, aggregate, ...) на
+// CLOCK_MONOTONIC. Часы общие для всей системы, поэтому отметки, снятые в
+// дочерних процессах, можно класть на ту же шкалу, что и в родителе.
+enum TimingFormat { TIMING_NONE, TIMING_TEXT, TIMING_JSON };
+
+#define SPAN_NAME_SIZE 24
+// Интервал без воркера (фаза всего прогона)
+#define SPAN_NO_WORKER -1
+
+struct Span {
+  char name[SPAN_NAME_SIZE];
+  int worker;
+  uint64_t start_ns;
+  uint64_t end_ns;
+};
+
+struct Timeline {
+  uint64_t origin_ns;
+  struct Span *spans;
+  int count;
+  int capacity;
+};
+
+// Текущее время CLOCK_MONOTONIC в наносекундах
+uint64_t MonotonicNs(void);
+
+// Начало шкалы - момент вызова
+void InitTimeline(struct Timeline *timeline);
+void FreeTimeline(struct Timeline *timeline);
+
+// Открывает интервал и возвращает его номер для EndSpan
+int BeginSpan(struct Timeline *timeline, const char *name, int worker);
+void EndSpan(struct Timeline *timeline, int span);
+// Интервал с уже известными границами (например, присланными воркером)
+void AddSpan(struct Timeline *timeline, const char *name, int worker,
+             uint64_t start_ns, uint64_t end_ns);
+
+// Длительность в миллисекундах; суммарная - по всем интервалам с именем
+double SpanMs(const struct Timeline *timeline, int span);
+double TotalSpanMs(const struct Timeline *timeline, const char *name);
+
+int ParseTimingFormat(const char *name, enum TimingFormat *format);
+// Текст: по строке на интервал со смещением от начала шкалы; JSON: один
+// объект {"spans": [...]} для скриптов
+void PrintTimeline(const struct Timeline *timeline, enum TimingFormat format,
+                   FILE *out);
+
+#endif
@@ -3,6 +3,10 @@
 
 #include "utils.h"
 
-struct MinMax GetMinMax(int *array, unsigned int begin, unsigned int end);
+// Ядро (scalar/sse4.1/avx2/avx512) выбирается при старте по возможностям CPU
+struct MinMax GetMinMax(int *array, size_t begin, size_t end);
+
+// Имя выбранного ядра, для вывода в отчетах о производительности
+const char *GetMinMaxKernelName(void);
 
 #endif
@@ -0,0 +1,138 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <getopt.h>
+
+#include "dataset.h"
+#include "typed_min_max.h"
+#include "utils.h"
+#include "zone_map.h"
+
+// Сохраняет массив GenerateArray (или GenerateTypedArray для --type) в
+// бинарный файл для режима --input
+int main(int argc, char **argv) {
+    int seed = -1;
+    size_t array_size = 0;
+    char *end;
+    const char *output = NULL;
+    int raw = 0;
+    int zone_size = 0;
+    enum ValueType type = VALUE_INT32;
+    long nan_every = 0;
+
+    static struct option options[] = {{"seed", required_argument, 0, 0},
+                                      {"array_size", required_argument, 0, 0},
+                                      {"output", required_argument, 0, 0},
+                                      {"raw", no_argument, 0, 0},
+                                      {"zone_size", required_argument, 0, 0},
+                                      {"type", required_argument, 0, 0},
+                                      {"nan_every", required_argument, 0, 0},
+                                      {0, 0, 0, 0}};
+
+    while (true) {
+        int option_index = 0;
+        int c = getopt_long(argc, argv, "", options, &option_index);
+        if (c == -1) break;
+        if (c != 0) continue;
+
+        switch (option_index) {
+            case 0:
+                seed = atoi(optarg);
+                if (seed <= 0) {
+                    printf("Seed must be a positive number\n");
+                    return 1;
+                }
+                break;
+            case 1:
+                // size_t: наборы данных бывают больше 2^31 элементов
+                array_size = (size_t)strtoull(optarg, &end, 10);
+                if (*optarg == '-' || *end != '\0' || array_size == 0) {
+                    printf("Array size must be a positive number\n");
+                    return 1;
+                }
+                break;
+            case 2:
+                output = optarg;
+                break;
+            case 3:
+                raw = 1;
+                break;
+            case 4:
+                zone_size = atoi(optarg);
+                if (zone_size <= 0) {
+                    printf("Zone size must be a positive number\n");
+                    return 1;
+                }
+                break;
+            case 5:
+                if (ParseValueType(optarg, &type) == -1) {
+                    printf("Type must be int8, int16, int32, int64, float or double\n");
+                    return 1;
+                }
+                break;
+            case 6:
+                nan_every = atol(optarg);
+                if (nan_every <= 0) {
+                    printf("NaN interval must be a positive number\n");
+                    return 1;
+                }
+                break;
+        }
+    }
+
+    if (seed == -1 || array_size == 0 || output == NULL) {
+        printf("Usage: %s --seed \"num\" --array_size \"num\" --output \"file\" [--raw | --zone_size \"num\"] [--type int8|int16|int32|int64|float|double [--nan_every \"num\"]]\n",
+               argv[0]);
+        return 1;
+    }
+    if (nan_every > 0 && !IsFloatType(type)) {
+        printf("NaNs apply to float and double only\n");
+        return 1;
+    }
+
+    // Другие типы: только заголовок и элементы, без сводок зон; каждый
+    // nan_every-й элемент - NaN, чтобы проверять вещественные ядра
+    if (type != VALUE_INT32) {
+        if (raw || zone_size > 0) {
+            printf("Raw files and zone maps hold int32 elements only\n");
+            return 1;
+        }
+        void *data = malloc(ValueTypeSize(type) * array_size);
+        if (data == NULL) {
+            perror("malloc failed");
+            return 1;
+        }
+        GenerateTypedArray(type, data, array_size, seed);
+        for (size_t i = nan_every - 1; nan_every > 0 && i < array_size;
+             i += nan_every) {
+            if (type == VALUE_FLOAT) ((float *)data)[i] = NAN;
+            else ((double *)data)[i] = NAN;
+        }
+        int result = WriteTypedDataset(output, data, array_size,
+                                       ValueTypeElement(type));
+        free(data);
+        return result == 0 ? 0 : 1;
+    }
+
+    int *array = malloc(sizeof(int) * array_size);
+    if (array == NULL) {
+        perror("malloc failed");
+        return 1;
+    }
+    GenerateArray(array, array_size, seed);
+
+    // Карта зон сохраняется в файл, чтобы запросы не строили ее заново
+    struct ZoneMap zones = {0};
+    if (zone_size > 0 && !raw &&
+        BuildZoneMap(&zones, array, array_size, zone_size, 0) == -1) {
+        printf("Failed to build zone map\n");
+        return 1;
+    }
+    int result = WriteDataset(output, array, array_size, raw, zones.zones,
+                              zones.zone_size, zones.zone_count);
+    FreeZoneMap(&zones);
+    free(array);
+    return result == 0 ? 0 : 1;
+}
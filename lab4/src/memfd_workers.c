@@ -0,0 +1,131 @@
+#define _GNU_SOURCE
+#include "memfd_workers.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+extern char **environ;
+
+int ParseSpawnMethod(const char *name, enum SpawnMethod *method) {
+  if (strcmp(name, "fork") == 0) {
+    *method = SPAWN_FORK;
+  } else if (strcmp(name, "exec") == 0) {
+    *method = SPAWN_EXEC;
+  } else if (strcmp(name, "posix_spawn") == 0) {
+    *method = SPAWN_POSIX_SPAWN;
+  } else {
+    return -1;
+  }
+  return 0;
+}
+
+const char *SpawnMethodName(enum SpawnMethod method) {
+  static const char *names[] = {"fork", "exec", "posix_spawn"};
+  return names[method];
+}
+
+int CreateMemfdDataset(struct MemfdDataset *dataset, size_t count) {
+  memset(dataset, 0, sizeof(*dataset));
+  size_t bytes = count * sizeof(int);
+  int fd = memfd_create("min_max_dataset", MFD_ALLOW_SEALING);
+  if (fd == -1) {
+    perror("memfd_create failed");
+    return -1;
+  }
+  if (ftruncate(fd, bytes) == -1) {
+    perror("ftruncate failed");
+    close(fd);
+    return -1;
+  }
+  void *map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    perror("mmap failed");
+    close(fd);
+    return -1;
+  }
+  dataset->fd = fd;
+  dataset->data = (int *)map;
+  dataset->count = count;
+  return 0;
+}
+
+int SealMemfdDataset(struct MemfdDataset *dataset) {
+  // F_SEAL_WRITE не ставится, пока есть отображения на запись
+  size_t bytes = dataset->count * sizeof(int);
+  munmap(dataset->data, bytes);
+  dataset->data = NULL;
+  if (fcntl(dataset->fd, F_ADD_SEALS,
+            F_SEAL_WRITE | F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == -1) {
+    perror("F_ADD_SEALS failed");
+  } else {
+    dataset->sealed = true;
+  }
+  void *map = mmap(NULL, bytes, PROT_READ, MAP_SHARED, dataset->fd, 0);
+  if (map == MAP_FAILED) {
+    perror("mmap failed");
+    return -1;
+  }
+  dataset->data = (int *)map;
+  return dataset->sealed ? 0 : -1;
+}
+
+void CloseMemfdDataset(struct MemfdDataset *dataset) {
+  if (dataset->data != NULL) {
+    munmap(dataset->data, dataset->count * sizeof(int));
+  }
+  if (dataset->fd > 0) close(dataset->fd);
+  memset(dataset, 0, sizeof(*dataset));
+}
+
+const int *MapMemfdDataset(int fd, size_t *count, bool *sealed) {
+  struct stat st;
+  if (fstat(fd, &st) == -1 || st.st_size == 0) {
+    fprintf(stderr, "fd %d: empty or unreadable dataset\n", fd);
+    return NULL;
+  }
+  void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    fprintf(stderr, "fd %d: mmap failed: %s\n", fd, strerror(errno));
+    return NULL;
+  }
+  int seals = fcntl(fd, F_GET_SEALS);
+  *sealed = seals != -1 && (seals & F_SEAL_WRITE);
+  *count = st.st_size / sizeof(int);
+  return (const int *)map;
+}
+
+pid_t SpawnWorker(enum SpawnMethod method, const char *path,
+                  char *const argv[], int stdout_fd) {
+  if (method == SPAWN_POSIX_SPAWN) {
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, stdout_fd, STDOUT_FILENO);
+    pid_t pid;
+    int error = posix_spawn(&pid, path, &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (error != 0) {
+      fprintf(stderr, "posix_spawn %s: %s\n", path, strerror(error));
+      return -1;
+    }
+    return pid;
+  }
+
+  // Иначе дочерний процесс напечатает буфер stdout повторно
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    dup2(stdout_fd, STDOUT_FILENO);
+    execv(path, argv);
+    fprintf(stderr, "execv %s: %s\n", path, strerror(errno));
+    _exit(127);
+  }
+  if (pid == -1) perror("fork failed");
+  return pid;
+}
@@ -0,0 +1,45 @@
+#ifndef MEMFD_WORKERS_H
+#define MEMFD_WORKERS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+// Как запускать воркеров: fork() с наследованием массива через
+// copy-on-write или отдельный исполняемый файл воркера (fork() + execv либо
+// posix_spawn), которому массив передается дескриптором memfd
+enum SpawnMethod { SPAWN_FORK, SPAWN_EXEC, SPAWN_POSIX_SPAWN };
+
+int ParseSpawnMethod(const char *name, enum SpawnMethod *method);
+const char *SpawnMethodName(enum SpawnMethod method);
+
+// Набор данных в анонимном файле memfd. Дескриптор создается без
+// close-on-exec: его номер передается воркеру в аргументах, и воркер сам
+// отображает данные только для чтения.
+struct MemfdDataset {
+  int fd;
+  int *data;
+  size_t count;
+  bool sealed;
+};
+
+// Создает memfd на count элементов и отображает его на запись; 0 или -1
+int CreateMemfdDataset(struct MemfdDataset *dataset, size_t count);
+// После заполнения запрещает запись и изменение размера (F_SEAL_WRITE,
+// F_SEAL_SHRINK, F_SEAL_GROW, F_SEAL_SEAL): воркер может доверять данным, не
+// копируя их. Отображение родителя становится только для чтения.
+int SealMemfdDataset(struct MemfdDataset *dataset);
+void CloseMemfdDataset(struct MemfdDataset *dataset);
+
+// Сторона воркера: отображает набор из fd только для чтения; NULL при
+// ошибке (сообщение уже напечатано). *sealed - запрещена ли запись.
+const int *MapMemfdDataset(int fd, size_t *count, bool *sealed);
+
+// Запускает path с argv, stdout воркера - stdout_fd. SPAWN_EXEC - fork() и
+// execv: fork() копирует таблицы страниц родителя, и это тем дольше, чем
+// больше его память. SPAWN_POSIX_SPAWN - posix_spawn, в glibc это
+// clone(CLONE_VM | CLONE_VFORK) без копирования. -1 при ошибке.
+pid_t SpawnWorker(enum SpawnMethod method, const char *path,
+                  char *const argv[], int stdout_fd);
+
+#endif
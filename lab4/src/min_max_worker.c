@@ -0,0 +1,89 @@
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include "memfd_workers.h"
+#include "topology.h"
+#include "utils.h"
+#include "zone_map.h"
+
+// Отдельный воркер для parallel_min_max --spawn exec|posix_spawn. Набор
+// данных получает унаследованным дескриптором memfd и отображает только
+// для чтения, считает min/max среза [begin, end) и пишет "min max" в
+// stdout, как воркер с передачей через пайп.
+int main(int argc, char **argv) {
+    int fd = -1;
+    long long begin = -1, end = -1;
+    bool with_filter = false;
+    struct ValueFilter filter = {INT_MIN, INT_MAX};
+    int cpu = -1;
+    bool require_seal = false;
+
+    static struct option options[] = {
+        {"fd", required_argument, 0, 0},
+        {"begin", required_argument, 0, 0},
+        {"end", required_argument, 0, 0},
+        {"where", required_argument, 0, 0},
+        {"cpu", required_argument, 0, 0},
+        {"require_seal", no_argument, 0, 0},
+        {0, 0, 0, 0}
+    };
+
+    int option_index = 0;
+    while (true) {
+        int c = getopt_long(argc, argv, "", options, &option_index);
+        if (c == -1) break;
+        if (c != 0) return 1;
+
+        switch (option_index) {
+            case 0:
+                fd = atoi(optarg);
+                break;
+            case 1:
+                begin = atoll(optarg);
+                break;
+            case 2:
+                end = atoll(optarg);
+                break;
+            case 3:
+                if (sscanf(optarg, "%d:%d", &filter.lo, &filter.hi) != 2) return 1;
+                with_filter = true;
+                break;
+            case 4:
+                cpu = atoi(optarg);
+                break;
+            case 5:
+                require_seal = true;
+                break;
+        }
+    }
+
+    if (fd < 0 || begin < 0 || end < begin) {
+        fprintf(stderr, "Usage: %s --fd \"num\" --begin \"num\" --end \"num\" [--where \"lo:hi\"] [--cpu \"num\"] [--require_seal]\n",
+                argv[0]);
+        return 1;
+    }
+
+    size_t count;
+    bool sealed;
+    const int *array = MapMemfdDataset(fd, &count, &sealed);
+    if (array == NULL) return 1;
+    if ((size_t)end > count) {
+        fprintf(stderr, "Slice [%lld, %lld) is out of %zu elements\n", begin,
+                end, count);
+        return 1;
+    }
+    if (require_seal && !sealed) {
+        fprintf(stderr, "Dataset is not sealed against writes\n");
+        return 1;
+    }
+    if (cpu >= 0) PinToCpu(cpu);
+
+    // Отображение только для чтения, ядро min/max массив не меняет
+    struct MinMax result = ZoneMinMax(NULL, (int *)array, begin, end,
+                                      with_filter ? &filter : NULL);
+    printf("%d %d", result.min, result.max);
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include <ctype.h>
+#include <fcntl.h>
 #include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -7,145 +8,608 @@
 #include <unistd.h>
 #include <signal.h>
 
-#include <sys/time.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/un.h>
 #include <sys/wait.h>
 
 #include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
 
+#include "dataset.h"
 #include "find_min_max.h"
+#include "memfd_workers.h"
+#include "perf_counters.h"
+#include "pool.h"
+#include "quantiles.h"
 #include <errno.h>
+#include "supervise.h"
+#include "timing.h"
+#include "topology.h"
+#include "typed_min_max.h"
 #include "utils.h"
+#include "worker_slots.h"
+#include "zone_map.h"
 
-volatile sig_atomic_t timeout_occurred = 0;
+// Движок: процессы, потоки или оба подряд для сравнения
+enum Mode { MODE_PROCESSES, MODE_THREADS, MODE_COMPARE };
 
-void timeout_handler(int sig) {
-    timeout_occurred = 1;
+// Способ передачи результата от дочернего процесса родителю
+enum Transport { TRANSPORT_PIPE, TRANSPORT_FILES, TRANSPORT_SHM };
+
+static const char *transport_names[] = {"pipe", "files", "shm"};
+
+#define DEFAULT_CHECKPOINT (1 << 20)
+
+// Со сводкой (квантили, top-k) массив сканируется блоками: сводка
+// пополняется блоком, пока он еще в кэше после min/max - один проход по памяти
+#define SUMMARY_BLOCK 8192
+#define MAX_QUANTILES 16
+
+// Как часто родитель проверяет прогресс воркеров при --speculate
+#define SPECULATE_POLL_MS 5
+
+// Блок, после которого поток проверяет отмену по таймауту (и при
+// --checkpoint 0, и с --type)
+#define CANCEL_BLOCK (1 << 20)
+
+static void MergeMinMax(struct MinMax *acc, struct MinMax part) {
+    if (part.min < acc->min) acc->min = part.min;
+    if (part.max > acc->max) acc->max = part.max;
 }
 
-int main(int argc, char **argv) {
-    int seed = -1;
-    int array_size = -1;
-    int pnum = -1;
-    int timeout = 0;
-    bool with_files = false;
+// Что и как сканирует воркер: массив, необязательные карта зон и фильтр
+// значений, начало запрошенного диапазона и шаг контрольных точек
+struct ScanParams {
+    int *array;
+    const struct ZoneMap *zones;
+    const struct ValueFilter *filter;
+    size_t offset;
+    size_t checkpoint;
+    // Флаг отмены для потоков (процессы по таймауту просто убиваются)
+    atomic_int *cancel;
+};
 
-    while (true) {
-        int current_optind = optind ? optind : 1;
+// Просматривает [begin, end) шагами по checkpoint элементов (0 - одним куском)
+// и после каждого шага публикует промежуточный min/max в слот воркера.
+// Сводка, если она есть, пополняется тем же проходом.
+static void ScanRange(const struct ScanParams *params, size_t begin,
+                      size_t end, struct WorkerSlot *slot,
+                      struct ValueSummary *summary, struct MinMax *local,
+                      unsigned long *scanned) {
+    size_t step = params->checkpoint > 0 ? params->checkpoint : end - begin;
+    if (summary && step > SUMMARY_BLOCK) step = SUMMARY_BLOCK;
+    // Потоки с отменой идут блоками и без контрольных точек
+    if (params->cancel && step > CANCEL_BLOCK) step = CANCEL_BLOCK;
+    int lo = params->filter ? params->filter->lo : INT_MIN;
+    int hi = params->filter ? params->filter->hi : INT_MAX;
+    while (begin < end) {
+        if (params->cancel && atomic_load_explicit(params->cancel,
+                                                   memory_order_relaxed)) {
+            return;
+        }
+        size_t stop = end - begin > step ? begin + step : end;
+        struct MinMax block = ZoneMinMax(params->zones, params->array, begin,
+                                         stop, params->filter);
+        MergeMinMax(local, block);
+        if (summary) {
+            AddToSummary(summary, params->array, begin, stop, lo, hi, block.max);
+        }
+        *scanned += stop - begin;
+        if (slot) PublishProgress(slot, *local, *scanned);
+        begin = stop;
+    }
+}
 
-        static struct option options[] = {{"seed", required_argument, 0, 0},
-                                          {"array_size", required_argument, 0, 0},
-                                          {"pnum", required_argument, 0, 0},
-                                          {"timeout", required_argument, 0, 0},
-                                          {"by_files", no_argument, 0, 'f'},
-                                          {0, 0, 0, 0}};
+// Работа одного воркера. Без очереди считает свой статический сегмент
+// [begin, end), с очередью забирает куски, пока они не закончатся.
+static struct MinMax RunWorker(const struct ScanParams *params,
+                               size_t begin, size_t end,
+                               struct ChunkQueue *queue,
+                               struct WorkerSlot *slot,
+                               struct ValueSummary *summary,
+                               unsigned long *scanned) {
+    struct MinMax local = {INT_MAX, INT_MIN};
+    *scanned = 0;
+    if (queue == NULL) {
+        ScanRange(params, begin, end, slot, summary, &local, scanned);
+        return local;
+    }
+    while ((params->cancel == NULL || !atomic_load(params->cancel)) &&
+           ClaimChunk(queue, &begin, &end)) {
+        ScanRange(params, params->offset + begin, params->offset + end, slot,
+                  summary, &local, scanned);
+    }
+    return local;
+}
 
-        int option_index = 0;
-        int c = getopt_long(argc, argv, "f", options, &option_index);
+// Параметры одного прогона, общие для процессов и потоков
+struct RunConfig {
+    struct ScanParams params;
+    size_t range_begin;
+    size_t range_end;
+    int pnum;
+    double timeout;
+    enum Transport transport;
+    int chunk_size;
+    bool track_progress;
+    // Привязка воркеров: cpus[i] - CPU i-го воркера, NULL - без привязки
+    const struct Topology *topology;
+    const int *cpus;
+    // Счетчики perf_event_open в каждом воркере
+    bool perf;
+    // Вывод шкалы фаз прогона
+    enum TimingFormat timing;
+    // Запрошенные квантили и размер top-k (0 - без них)
+    const double *quantiles;
+    int quantile_count;
+    unsigned int top_k;
+    // Перезапуск отстающих: воркер, чье прогнозное время больше speculate
+    // медиан завершившихся, получает запасной процесс на остаток (0 - выкл.)
+    double speculate;
+    // Запуск воркеров: fork() или исполняемый файл worker_path, которому
+    // массив передается дескриптором memfd
+    enum SpawnMethod spawn;
+    const struct MemfdDataset *memfd;
+    const char *worker_path;
+};
 
-        if (c == -1) break;
+struct RunResult {
+    struct MinMax min_max;
+    bool timed_out;
+    int completed;
+    unsigned long scanned;
+    double elapsed_ms;
+    double collect_ms;
+    // Фазы прогона: spawn, compute (по воркерам), wait, transfer, aggregate
+    struct Timeline timeline;
+    // Статистика воркеров при привязке к CPU (иначе NULL)
+    unsigned long *worker_elements;
+    double *worker_ms;
+    // Счетчики воркеров при --perf (иначе NULL)
+    struct PerfValues *worker_perf;
+    // Слитые сводки воркеров при квантилях или top-k (иначе NULL)
+    struct ValueSummary *summary;
+    // Сколько запасных процессов запущено и сколько из них успели первыми
+    int backups;
+    int backups_won;
+};
 
-        switch (c) {
-            case 0:
-                switch (option_index) {
-                    case 0:
-                        seed = atoi(optarg);
-                        if (seed <= 0) {
-                            printf("Seed must be a positive number\n");
-                            return 1;
-                        }
-                        break;
-                    case 1:
-                        array_size = atoi(optarg);
-                        if (array_size <= 0) {
-                            printf("Array size must be a positive number\n");
-                            return 1;
-                        }
-                        break;
-                    case 2:
-                        pnum = atoi(optarg);
-                        if (pnum <= 0) {
-                            printf("Process number must be a positive number\n");
-                            return 1;
-                        }
-                        break;
-                    case 3:
-                        timeout = atoi(optarg);
-                        if (timeout <= 0) {
-                            printf("Timeout must be a positive number\n");
-                            return 1;
-                        }
-                        break;
-                    case 4:
-                        with_files = true;
-                        break;
+static void FreeRunResult(struct RunResult *result) {
+    free(result->summary);
+    free(result->worker_elements);
+    free(result->worker_ms);
+    free(result->worker_perf);
+    FreeTimeline(&result->timeline);
+}
 
-                    default:
-                        printf("Index %d is out of options\n", option_index);
+// Статический сегмент i-го воркера внутри запрошенного диапазона
+static void WorkerSegment(const struct RunConfig *config, int i,
+                          size_t *begin, size_t *end) {
+    size_t range_size = config->range_end - config->range_begin;
+    size_t segment_size = range_size / config->pnum;
+    *begin = config->range_begin + i * segment_size;
+    *end = (i == config->pnum - 1) ? config->range_end : *begin + segment_size;
+}
+
+// Воркер i целиком: привязка к CPU, сканирование своей части и, при
+// привязке, статистика для разбивки пропускной способности по узлам
+static struct MinMax RunWorkerAt(const struct RunConfig *config,
+                                 const struct ScanParams *params, int i,
+                                 struct ChunkQueue *queue,
+                                 struct WorkerSlot *progress,
+                                 struct WorkerSlot *stats,
+                                 struct PerfValues *perf,
+                                 struct ValueSummary *summary) {
+    size_t start, end;
+    WorkerSegment(config, i, &start, &end);
+    if (config->cpus) PinToCpu(config->cpus[i]);
+    if (summary) {
+        InitSummary(summary, config->quantile_count > 0, config->top_k, i + 1);
+    }
+
+    struct PerfCounters counters;
+    if (perf) StartPerfCounters(&counters);
+    uint64_t started = MonotonicNs();
+    unsigned long scanned;
+    struct MinMax local = RunWorker(params, start, end, queue, progress,
+                                    summary, &scanned);
+    uint64_t finished = MonotonicNs();
+    if (perf) StopPerfCounters(&counters, perf);
+
+    if (stats) PublishStats(stats, scanned, started, finished);
+    return local;
+}
+
+// Забирает статистику воркеров из слотов до их освобождения: интервалы
+// compute на шкалу и, при привязке к CPU, элементы и время для разбивки
+static void CollectStats(const struct RunConfig *config,
+                         struct WorkerSlot *slots, struct RunResult *result) {
+    if (config->cpus) {
+        result->worker_elements = malloc(config->pnum * sizeof(unsigned long));
+        result->worker_ms = malloc(config->pnum * sizeof(double));
+    }
+    for (int i = 0; i < config->pnum; i++) {
+        unsigned long started, finished;
+        unsigned long elements = ReadStats(&slots[i], &started, &finished);
+        if (finished != 0) {
+            AddSpan(&result->timeline, "compute", i, started, finished);
+        }
+        if (config->cpus) {
+            result->worker_elements[i] = elements;
+            result->worker_ms[i] = finished ? (finished - started) / 1e6 : 0;
+        }
+    }
+}
+
+// Копирует счетчики воркеров из общей памяти и освобождает ее
+static void CollectPerf(const struct RunConfig *config,
+                        struct PerfValues *perf_slots, struct RunResult *result) {
+    if (perf_slots == NULL) return;
+    result->worker_perf = malloc(config->pnum * sizeof(struct PerfValues));
+    memcpy(result->worker_perf, perf_slots,
+           config->pnum * sizeof(struct PerfValues));
+    DestroyPerfSlots(perf_slots, config->pnum);
+}
+
+// Сводки воркеров в общей памяти и слитая сводка результата, если
+// запрошены квантили или top-k
+static struct ValueSummary *CreateSummaries(const struct RunConfig *config,
+                                            struct RunResult *result) {
+    if (config->quantile_count == 0 && config->top_k == 0) return NULL;
+    result->summary = malloc(sizeof(struct ValueSummary));
+    InitSummary(result->summary, config->quantile_count > 0, config->top_k, 0);
+    struct ValueSummary *slots = CreateSummarySlots(config->pnum);
+    if (slots == NULL) {
+        perror("mmap failed");
+        free(result->summary);
+        result->summary = NULL;
+    }
+    return slots;
+}
+
+// Учитывает результат воркера или, если его нет, последнюю контрольную точку.
+// Сводка берется только у закончивших воркеров: контрольных точек у нее нет.
+static void CollectWorker(const struct RunConfig *config,
+                          struct WorkerSlot *slot, bool result_read,
+                          struct MinMax worker,
+                          const struct ValueSummary *summary,
+                          struct RunResult *result) {
+    struct MinMax partial;
+    if (result_read) {
+        MergeMinMax(&result->min_max, worker);
+        if (summary) MergeSummary(result->summary, summary);
+        if (config->track_progress) result->scanned += ReadProgress(slot, &partial);
+    } else if (config->track_progress) {
+        unsigned long scanned = ReadProgress(slot, &partial);
+        if (scanned > 0) {
+            MergeMinMax(&result->min_max, partial);
+            result->scanned += scanned;
+        }
+    }
+}
+
+// Запасной процесс отстающего воркера: считает недосчитанный остаток его
+// сегмента [begin, end). snapshot - контрольная точка воркера на момент
+// запуска, она покрывает начало сегмента до begin.
+struct Speculation {
+    bool launched;
+    size_t begin;
+    size_t end;
+    struct MinMax snapshot;
+    unsigned long snapshot_scanned;
+    int cpu;
+};
+
+static int CompareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double Median(const double *values, int count) {
+    double sorted[count];
+    memcpy(sorted, values, count * sizeof(double));
+    qsort(sorted, count, sizeof(double), CompareDoubles);
+    return sorted[count / 2];
+}
+
+// Запасной процесс всегда отдает результат через общую память, в свой слот
+static pid_t LaunchBackup(const struct RunConfig *config,
+                          struct WorkerSlot *slot,
+                          const struct Speculation *speculation) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (speculation->cpu >= 0) PinToCpu(speculation->cpu);
+        uint64_t started = MonotonicNs();
+        unsigned long scanned;
+        struct MinMax local = RunWorker(&config->params, speculation->begin,
+                                        speculation->end, NULL, slot, NULL,
+                                        &scanned);
+        PublishStats(slot, scanned, started, MonotonicNs());
+        PublishResult(slot, local);
+        _exit(0);
+    }
+    return pid;
+}
+
+// Сегмент готов, когда первым завершился его воркер (номер i) или запасной
+// процесс (номер pnum + i); второй убивается. Пока есть свободные воркеры
+// (процессов меньше pnum), отстающим запускаются запасные на CPU
+// завершившихся. Возвращает число готовых сегментов или -1.
+static int SuperviseSpeculative(const struct RunConfig *config,
+                                const pid_t *pids, uint64_t spawn_ns,
+                                struct WorkerSlot *slots,
+                                struct WorkerSlot *backup_slots,
+                                struct Speculation *speculation,
+                                struct RunResult *result) {
+    int pnum = config->pnum;
+    struct Supervisor supervisor;
+    if (OpenSupervisor(&supervisor, 2 * pnum, config->timeout) == -1) return -1;
+    for (int i = 0; i < pnum; i++) SuperviseChild(&supervisor, i, pids[i]);
+
+    bool *resolved = calloc(pnum, sizeof(bool));
+    double *finish_ms = malloc(pnum * sizeof(double));
+    int *free_cpus = malloc(2 * pnum * sizeof(int));
+    int finished_count = 0, free_count = 0, completed = 0;
+    int running = pnum;
+
+    while (true) {
+        bool exited_ok;
+        int tag = WaitNextChild(&supervisor, SPECULATE_POLL_MS, &exited_ok);
+        if (tag != SUPERVISE_IDLE && tag < 0) break;
+
+        // Завершился процесс: его CPU свободен, сегмент, возможно, готов
+        for (int exited = tag; exited >= 0;) {
+            int i = exited % pnum;
+            bool backup = exited >= pnum;
+            running--;
+            if (config->cpus) {
+                free_cpus[free_count++] =
+                    backup ? speculation[i].cpu : config->cpus[i];
+            }
+            exited = -1;
+            if (exited_ok && !resolved[i]) {
+                resolved[i] = true;
+                completed++;
+                if (backup) result->backups_won++;
+                else finish_ms[finished_count++] = (MonotonicNs() - spawn_ns) / 1e6;
+                int other = backup ? i : pnum + i;
+                if (supervisor.running[other]) {
+                    KillChild(&supervisor, other);
+                    exited_ok = false;
+                    exited = other;
                 }
-                break;
-            case 'f':
-                with_files = true;
-                break;
+            }
+        }
 
-            case '?':
-                break;
+        // Отстающий: прогноз по его скорости хуже speculate медиан
+        if (finished_count == 0) continue;
+        double threshold = config->speculate * Median(finish_ms, finished_count);
+        double elapsed = (MonotonicNs() - spawn_ns) / 1e6;
+        for (int i = 0; i < pnum && running < pnum; i++) {
+            if (resolved[i] || speculation[i].launched || !supervisor.running[i]) {
+                continue;
+            }
+            size_t begin, end;
+            WorkerSegment(config, i, &begin, &end);
+            struct MinMax partial;
+            unsigned long scanned = ReadProgress(&slots[i], &partial);
+            // Без единой контрольной точки прогноза нет: ждем сам порог
+            if (scanned >= end - begin) continue;
+            double projected = scanned > 0 ? elapsed * (end - begin) / scanned
+                                           : elapsed;
+            if (projected <= threshold) continue;
 
-            default:
-                printf("getopt returned character code 0%o?\n", c);
+            struct Speculation *backup = &speculation[i];
+            backup->begin = begin + scanned;
+            backup->end = end;
+            backup->snapshot = partial;
+            backup->snapshot_scanned = scanned;
+            backup->cpu = free_count > 0 ? free_cpus[--free_count] : -1;
+            pid_t pid = LaunchBackup(config, &backup_slots[i], backup);
+            if (pid == -1) {
+                perror("fork failed");
+                break;
+            }
+            backup->launched = true;
+            result->backups++;
+            SuperviseChild(&supervisor, pnum + i, pid);
+            running++;
         }
     }
 
-    if (optind < argc) {
-        printf("Has at least one no option argument\n");
-        return 1;
+    // Процессы без pidfd дожидаются здесь; после таймаута все добиваются
+    bool *finished = calloc(2 * pnum, sizeof(bool));
+    CloseSupervisor(&supervisor, finished);
+    for (int tag = 0; tag < 2 * pnum; tag++) {
+        int i = tag % pnum;
+        if (!finished[tag] || resolved[i]) continue;
+        resolved[i] = true;
+        completed++;
+        if (tag >= pnum) result->backups_won++;
     }
+    result->timed_out = supervisor.timed_out;
 
-    if (seed == -1 || array_size == -1 || pnum == -1) {
-        printf("Usage: %s --seed \"num\" --array_size \"num\" --pnum \"num\" [--timeout \"num\"] [--by_files]\n",
-               argv[0]);
-        return 1;
+    free(finished);
+    free(resolved);
+    free(finish_ms);
+    free(free_cpus);
+    return completed;
+}
+
+// Сегмент с запасным процессом, у воркера которого нет результата:
+// контрольная точка плюс остаток, а по таймауту - все, что успели оба
+static void CollectSpeculation(struct WorkerSlot *slot,
+                               struct WorkerSlot *backup_slot,
+                               const struct Speculation *speculation,
+                               struct RunResult *result) {
+    struct MinMax backup;
+    if (speculation->snapshot_scanned > 0) {
+        MergeMinMax(&result->min_max, speculation->snapshot);
+    }
+    if (ReadResult(backup_slot, &backup)) {
+        MergeMinMax(&result->min_max, backup);
+        result->scanned += speculation->snapshot_scanned +
+                           (speculation->end - speculation->begin);
+        return;
     }
 
-    // Устанавливаем таймаут
-    pid_t timeout_pid = 0;
-    if (timeout > 0) {
-        printf("Timeout set to %d seconds\n", timeout);
-        
-        timeout_pid = fork();
-        if (timeout_pid == 0) {
-            sleep(timeout);
-            kill(getppid(), SIGUSR1);
-            exit(0);
-        } else if (timeout_pid < 0) {
-            printf("Failed to create timeout process\n");
-            return 1;
+    struct MinMax partial;
+    unsigned long backup_scanned = ReadProgress(backup_slot, &partial);
+    if (backup_scanned > 0) MergeMinMax(&result->min_max, partial);
+    unsigned long scanned = ReadProgress(slot, &partial);
+    if (scanned > 0) MergeMinMax(&result->min_max, partial);
+    unsigned long covered = speculation->snapshot_scanned + backup_scanned;
+    result->scanned += scanned > covered ? scanned : covered;
+}
+
+// Воркеры - отдельные процессы min_max_worker: массив им передается
+// дескриптором memfd, срез и фильтр - аргументами, результат приходит
+// пайпом на их stdout. Память родителя они не наследуют.
+static int RunExecProcesses(const struct RunConfig *config,
+                            struct RunResult *result) {
+    int pnum = config->pnum;
+    memset(result, 0, sizeof(*result));
+    result->min_max.min = INT_MAX;
+    result->min_max.max = INT_MIN;
+    struct Timeline *timeline = &result->timeline;
+    InitTimeline(timeline);
+
+    int *read_fds = malloc(pnum * sizeof(int));
+    pid_t *child_pids = malloc(pnum * sizeof(pid_t));
+    int started = 0;
+    int spawn_span = BeginSpan(timeline, "spawn", SPAN_NO_WORKER);
+    for (int i = 0; i < pnum; i++) {
+        // close-on-exec: иначе воркер унаследует концы записи чужих пайпов,
+        // и их читатель не дождется EOF
+        int pipefd[2];
+        if (pipe(pipefd) == -1) {
+            perror("pipe failed");
+            break;
+        }
+        fcntl(pipefd[0], F_SETFD, FD_CLOEXEC);
+        fcntl(pipefd[1], F_SETFD, FD_CLOEXEC);
+
+        size_t begin, end;
+        WorkerSegment(config, i, &begin, &end);
+        char fd_arg[16], begin_arg[24], end_arg[24], where_arg[32], cpu_arg[16];
+        snprintf(fd_arg, sizeof(fd_arg), "%d", config->memfd->fd);
+        snprintf(begin_arg, sizeof(begin_arg), "%zu", begin);
+        snprintf(end_arg, sizeof(end_arg), "%zu", end);
+        char *argv[12];
+        int argc = 0;
+        argv[argc++] = (char *)"min_max_worker";
+        argv[argc++] = (char *)"--fd";
+        argv[argc++] = fd_arg;
+        argv[argc++] = (char *)"--begin";
+        argv[argc++] = begin_arg;
+        argv[argc++] = (char *)"--end";
+        argv[argc++] = end_arg;
+        if (config->params.filter) {
+            snprintf(where_arg, sizeof(where_arg), "%d:%d",
+                     config->params.filter->lo, config->params.filter->hi);
+            argv[argc++] = (char *)"--where";
+            argv[argc++] = where_arg;
+        }
+        if (config->cpus) {
+            snprintf(cpu_arg, sizeof(cpu_arg), "%d", config->cpus[i]);
+            argv[argc++] = (char *)"--cpu";
+            argv[argc++] = cpu_arg;
+        }
+        if (config->memfd->sealed) argv[argc++] = (char *)"--require_seal";
+        argv[argc] = NULL;
+
+        child_pids[i] = SpawnWorker(config->spawn, config->worker_path, argv,
+                                    pipefd[1]);
+        close(pipefd[1]);
+        if (child_pids[i] == -1) {
+            close(pipefd[0]);
+            break;
+        }
+        read_fds[i] = pipefd[0];
+        started++;
+    }
+    EndSpan(timeline, spawn_span);
+
+    bool *finished = malloc(pnum * sizeof(bool));
+    int wait_span = BeginSpan(timeline, "wait", SPAN_NO_WORKER);
+    result->completed = SuperviseChildren(child_pids, started, config->timeout,
+                                          finished, &result->timed_out);
+    EndSpan(timeline, wait_span);
+    if (result->timed_out) {
+        printf("Timeout occurred! Child processes were killed\n");
+    }
+
+    // Без таймаута каждый воркер обязан вернуть ответ: упавший exec,
+    // непрошедшая проверка печати или среза - ошибка всего прогона, а не
+    // молча выпавший сегмент
+    int failed = 0;
+    int transfer_span = BeginSpan(timeline, "transfer", SPAN_NO_WORKER);
+    for (int i = 0; i < started; i++) {
+        struct MinMax worker;
+        FILE *stream = fdopen(read_fds[i], "r");
+        bool answered = false;
+        if (stream == NULL) {
+            close(read_fds[i]);
+        } else {
+            answered = finished[i] &&
+                       fscanf(stream, "%d %d", &worker.min, &worker.max) == 2;
+            fclose(stream);
+        }
+        if (answered) {
+            size_t begin, end;
+            WorkerSegment(config, i, &begin, &end);
+            MergeMinMax(&result->min_max, worker);
+            result->scanned += end - begin;
+        } else if (!result->timed_out) {
+            printf("Worker %d failed without a result\n", i);
+            failed++;
         }
-        
-        struct sigaction sa;
-        sa.sa_handler = timeout_handler;
-        sigemptyset(&sa.sa_mask);
-        sa.sa_flags = 0;
-        sigaction(SIGUSR1, &sa, NULL);
     }
+    EndSpan(timeline, transfer_span);
+
+    result->collect_ms = SpanMs(timeline, transfer_span);
+    result->elapsed_ms = (MonotonicNs() - timeline->origin_ns) / 1e6;
+    free(read_fds);
+    free(child_pids);
+    free(finished);
+    if (failed > 0) {
+        printf("%d of %d workers failed, no result for the whole range\n",
+               failed, pnum);
+    }
+    return started == pnum && result->completed >= 0 && failed == 0 ? 0 : -1;
+}
 
-    int *array = malloc(sizeof(int) * array_size);
-    GenerateArray(array, array_size, seed);
-    int active_child_processes = 0;
+// Движок на процессах: fork() на каждого воркера, результат через пайп,
+// файл или общую память, по таймауту - SIGKILL
+static int RunProcesses(const struct RunConfig *config,
+                        struct RunResult *result) {
+    if (config->spawn != SPAWN_FORK) return RunExecProcesses(config, result);
+    int pnum = config->pnum;
+    enum Transport transport = config->transport;
+    memset(result, 0, sizeof(*result));
+    result->min_max.min = INT_MAX;
+    result->min_max.max = INT_MIN;
+    struct Timeline *timeline = &result->timeline;
 
-    // Создаем пайпы или файлы 
+    // Создаем пайпы, файлы или общую память
     int *pipefds = NULL;
     char **filenames = NULL;
+    struct WorkerSlot *slots = NULL;
     
-    if (!with_files) {
+    if (transport == TRANSPORT_PIPE) {
         pipefds = malloc(2 * pnum * sizeof(int));
         for (int i = 0; i < pnum; i++) {
             if (pipe(pipefds + 2*i) == -1) {
                 perror("pipe failed");
-                return 1;
+                return -1;
             }
         }
-    } else {
+    } else if (transport == TRANSPORT_FILES) {
         filenames = malloc(pnum * sizeof(char*));
         for (int i = 0; i < pnum; i++) {
             filenames[i] = malloc(20 * sizeof(char));
@@ -153,11 +617,43 @@ int main(int argc, char **argv) {
         }
     }
 
-    struct timeval start_time;
-    gettimeofday(&start_time, NULL);
+    // Слоты в общей памяти нужны для передачи через shm, для учета
+    // прогресса по кускам и контрольным точкам и для времени воркеров
+    struct ChunkQueue *queue = NULL;
+    slots = CreateWorkerSlots(pnum);
+    if (slots == NULL) {
+        perror("mmap failed");
+        return -1;
+    }
+    if (config->chunk_size > 0) {
+        queue = CreateChunkQueue(config->range_end - config->range_begin,
+                                 config->chunk_size);
+        if (queue == NULL) {
+            perror("mmap failed");
+            return -1;
+        }
+    }
+    struct PerfValues *perf_slots = config->perf ? CreatePerfSlots(pnum) : NULL;
+    struct ValueSummary *summary_slots = CreateSummaries(config, result);
+    struct WorkerSlot *backup_slots = NULL;
+    struct Speculation *speculation = NULL;
+    if (config->speculate > 0) {
+        backup_slots = CreateWorkerSlots(pnum);
+        if (backup_slots == NULL) {
+            perror("mmap failed");
+            return -1;
+        }
+        speculation = calloc(pnum, sizeof(struct Speculation));
+    }
+    InitTimeline(timeline);
+
+    // Сбрасываем буфер stdout, иначе дочерние процессы напечатают его повторно
+    fflush(stdout);
 
     // Сохраняем PID дочерних процессов
     pid_t *child_pids = malloc(pnum * sizeof(pid_t));
+    uint64_t spawn_ns = MonotonicNs();
+    int spawn_span = BeginSpan(timeline, "spawn", SPAN_NO_WORKER);
 
     for (int i = 0; i < pnum; i++) {
         pid_t child_pid = fork();
@@ -165,115 +661,74 @@ int main(int argc, char **argv) {
         
         if (child_pid >= 0) {
             // successful fork
-            active_child_processes += 1;
             if (child_pid == 0) {
                 // child process
+                struct MinMax local = RunWorkerAt(
+                    config, &config->params, i, queue,
+                    config->track_progress ? &slots[i] : NULL, &slots[i],
+                    perf_slots ? &perf_slots[i] : NULL,
+                    summary_slots ? &summary_slots[i] : NULL);
                 
-                int chunk_size = array_size / pnum;
-                int start = i * chunk_size;
-                int end = (i == pnum - 1) ? array_size : start + chunk_size;
-                
-                int local_min = INT_MAX;
-                int local_max = INT_MIN;
-                
-                for (int j = start; j < end; j++) {
-                    if (array[j] < local_min) local_min = array[j];
-                    if (array[j] > local_max) local_max = array[j];
-                }
-                
-                if (with_files) {
+                if (transport == TRANSPORT_SHM) {
+                    PublishResult(&slots[i], local);
+                } else if (transport == TRANSPORT_FILES) {
                     FILE *file = fopen(filenames[i], "w");
                     if (file) {
-                        fprintf(file, "%d %d", local_min, local_max);
+                        fprintf(file, "%d %d", local.min, local.max);
                         fclose(file);
                     }
                 } else {
                     close(pipefds[2*i]);
                     FILE *stream = fdopen(pipefds[2*i + 1], "w");
                     if (stream) {
-                        fprintf(stream, "%d %d", local_min, local_max);
+                        fprintf(stream, "%d %d", local.min, local.max);
                         fclose(stream);
                     }
-                    close(pipefds[2*i + 1]);
-                }
-                
-                free(array);
-                if (pipefds) free(pipefds);
-                if (filenames) {
-                    for (int j = 0; j < pnum; j++) free(filenames[j]);
-                    free(filenames);
                 }
-                free(child_pids);
                 
-                return 0;
+                // Память процесса освободит ядро, буферы stdio уже сброшены
+                _exit(0);
             }
         } else {
             printf("Fork failed!\n");
-            return 1;
+            return -1;
         }
     }
 
-    // Ожидаем завершения дочерних процессов с проверкой таймаута
-    int completed_processes = 0;
-    while (active_child_processes > 0 && !timeout_occurred) {
-        int status;
-        pid_t finished_pid = waitpid(-1, &status, WNOHANG);
-        
-        if (finished_pid > 0) {
-            active_child_processes -= 1;
-            completed_processes++;
-        } else if (finished_pid == 0) {
-            if (timeout_occurred) {
-                printf("Timeout occurred! Killing child processes...\n");
-                break;
-            }
-            usleep(100000); // проверяем таймаут каждые 100мс
-        } else {
-            if (errno != ECHILD) {
-                perror("waitpid failed");
-            }
-            break;
-        }
-    }
+    EndSpan(timeline, spawn_span);
 
-    if (timeout_occurred) {
-        printf("Terminating child processes due to timeout...\n");
-        for (int i = 0; i < pnum; i++) {
-            if (child_pids[i] > 0) {
-                kill(child_pids[i], SIGKILL);
-            }
-        }
-        
-        // Ждем завершения убитых процессов
-        while (active_child_processes > 0) {
-            int status;
-            pid_t finished_pid = wait(&status);
-            if (finished_pid > 0) {
-                active_child_processes -= 1;
-            } else {
-                break;
-            }
-        }
+    // Ожидаем завершения дочерних процессов: epoll по pidfd плюс timerfd
+    bool *finished = malloc(pnum * sizeof(bool));
+    int wait_span = BeginSpan(timeline, "wait", SPAN_NO_WORKER);
+    if (speculation) {
+        result->completed = SuperviseSpeculative(config, child_pids, spawn_ns,
+                                                 slots, backup_slots,
+                                                 speculation, result);
+    } else {
+        result->completed = SuperviseChildren(child_pids, pnum, config->timeout,
+                                              finished, &result->timed_out);
     }
-
-    if (timeout_pid > 0) {
-        kill(timeout_pid, SIGKILL);
-        waitpid(timeout_pid, NULL, 0);
+    EndSpan(timeline, wait_span);
+    if (result->completed < 0) return -1;
+    if (result->timed_out) {
+        printf("Timeout occurred! Child processes were killed\n");
     }
 
-    struct MinMax min_max;
-    min_max.min = INT_MAX;
-    min_max.max = INT_MIN;
-
+    // Отдельно замеряем передачу результатов, чтобы сравнивать способы
+    // передачи, и их объединение
+    struct MinMax *workers = malloc(pnum * sizeof(struct MinMax));
+    bool *results_read = malloc(pnum * sizeof(bool));
+    int transfer_span = BeginSpan(timeline, "transfer", SPAN_NO_WORKER);
     for (int i = 0; i < pnum; i++) {
-        int min = INT_MAX;
-        int max = INT_MIN;
+        struct MinMax worker = {INT_MAX, INT_MIN};
         bool result_read = false;
 
-        if (with_files) {
+        if (transport == TRANSPORT_SHM) {
+            result_read = ReadResult(&slots[i], &worker);
+        } else if (transport == TRANSPORT_FILES) {
             FILE *file = fopen(filenames[i], "r");
             if (file) {
-                if (fscanf(file, "%d %d", &min, &max) == 2) {
+                if (fscanf(file, "%d %d", &worker.min, &worker.max) == 2) {
                     result_read = true;
                 }
                 fclose(file);
@@ -283,50 +738,1206 @@ int main(int argc, char **argv) {
             close(pipefds[2*i + 1]);
             FILE *stream = fdopen(pipefds[2*i], "r");
             if (stream) {
-                if (fscanf(stream, "%d %d", &min, &max) == 2) {
+                if (fscanf(stream, "%d %d", &worker.min, &worker.max) == 2) {
                     result_read = true;
                 }
                 fclose(stream);
             }
-            close(pipefds[2*i]);
         }
 
-        if (result_read) {
-            if (min < min_max.min) min_max.min = min;
-            if (max > min_max.max) min_max.max = max;
-        }
+        workers[i] = worker;
+        results_read[i] = result_read;
     }
+    EndSpan(timeline, transfer_span);
 
-    struct timeval finish_time;
-    gettimeofday(&finish_time, NULL);
+    int aggregate_span = BeginSpan(timeline, "aggregate", SPAN_NO_WORKER);
+    for (int i = 0; i < pnum; i++) {
+        if (speculation && speculation[i].launched && !results_read[i]) {
+            CollectSpeculation(&slots[i], &backup_slots[i], &speculation[i],
+                               result);
+        } else {
+            CollectWorker(config, &slots[i], results_read[i], workers[i],
+                          summary_slots ? &summary_slots[i] : NULL, result);
+        }
+    }
+    EndSpan(timeline, aggregate_span);
 
-    double elapsed_time = (finish_time.tv_sec - start_time.tv_sec) * 1000.0;
-    elapsed_time += (finish_time.tv_usec - start_time.tv_usec) / 1000.0;
+    result->collect_ms =
+        SpanMs(timeline, transfer_span) + SpanMs(timeline, aggregate_span);
+    result->elapsed_ms = (MonotonicNs() - timeline->origin_ns) / 1e6;
+    CollectStats(config, slots, result);
+    CollectPerf(config, perf_slots, result);
+    if (speculation) {
+        // Запасные процессы на шкале как backup с номером их воркера
+        for (int i = 0; i < pnum; i++) {
+            unsigned long started, finished_ns;
+            ReadStats(&backup_slots[i], &started, &finished_ns);
+            if (finished_ns != 0) {
+                AddSpan(timeline, "backup", i, started, finished_ns);
+            }
+        }
+        DestroyWorkerSlots(backup_slots, pnum);
+        free(speculation);
+    }
 
-    free(array);
+    DestroyWorkerSlots(slots, pnum);
+    if (summary_slots) DestroySummarySlots(summary_slots, pnum);
+    free(workers);
+    free(results_read);
+    if (queue) DestroyChunkQueue(queue);
     if (pipefds) free(pipefds);
     if (filenames) {
         for (int i = 0; i < pnum; i++) free(filenames[i]);
         free(filenames);
     }
     free(child_pids);
+    free(finished);
+    return 0;
+}
+
+// Движок на потоках: общее адресное пространство, результаты сразу в
+// выровненные по кэш-линии слоты. Поток нельзя убить, поэтому по таймауту
+// выставляется флаг отмены, который воркеры проверяют в контрольных точках.
+struct ThreadWorker {
+    const struct RunConfig *config;
+    struct ScanParams params;
+    struct ChunkQueue *queue;
+    struct WorkerSlot *slot;
+    struct PerfValues *perf;
+    struct ValueSummary *summary;
+    int index;
+    pthread_mutex_t *lock;
+    pthread_cond_t *done_cond;
+    int *done;
+};
+
+static void *ThreadWorkerMain(void *arg) {
+    struct ThreadWorker *worker = (struct ThreadWorker *)arg;
+    struct MinMax local =
+        RunWorkerAt(worker->config, &worker->params, worker->index,
+                    worker->queue, worker->slot, worker->slot, worker->perf,
+                    worker->summary);
+    if (!atomic_load(worker->params.cancel)) PublishResult(worker->slot, local);
+
+    pthread_mutex_lock(worker->lock);
+    (*worker->done)++;
+    pthread_cond_signal(worker->done_cond);
+    pthread_mutex_unlock(worker->lock);
+    return NULL;
+}
 
-    if (timeout_occurred) {
-        printf("Execution terminated due to timeout after %d seconds\n", timeout);
-        printf("Completed processes: %d/%d\n", completed_processes, pnum);
-        if (min_max.min != INT_MAX && min_max.max != INT_MIN) {
-            printf("Partial results from completed processes:\n");
-            printf("Min: %d\n", min_max.min);
-            printf("Max: %d\n", min_max.max);
+// Момент CLOCK_MONOTONIC через seconds секунд, для pthread_cond_timedwait
+static struct timespec DeadlineAfter(double seconds) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    double whole = (double)(time_t)seconds;
+    deadline.tv_sec += (time_t)seconds;
+    deadline.tv_nsec += (long)((seconds - whole) * 1e9);
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return deadline;
+}
+
+static int RunThreads(const struct RunConfig *config, struct RunResult *result) {
+    int pnum = config->pnum;
+    memset(result, 0, sizeof(*result));
+    result->min_max.min = INT_MAX;
+    result->min_max.max = INT_MIN;
+
+    struct WorkerSlot *slots = CreateWorkerSlots(pnum);
+    struct ChunkQueue *queue = NULL;
+    if (slots == NULL) {
+        perror("mmap failed");
+        return -1;
+    }
+    if (config->chunk_size > 0) {
+        queue = CreateChunkQueue(config->range_end - config->range_begin,
+                                 config->chunk_size);
+        if (queue == NULL) {
+            perror("mmap failed");
+            return -1;
+        }
+    }
+
+    struct PerfValues *perf_slots = config->perf ? CreatePerfSlots(pnum) : NULL;
+    struct ValueSummary *summary_slots = CreateSummaries(config, result);
+    atomic_int cancel;
+    atomic_init(&cancel, 0);
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    pthread_condattr_t cond_attr;
+    pthread_cond_t done_cond;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&done_cond, &cond_attr);
+    int done = 0;
+
+    struct ThreadWorker *workers = malloc(pnum * sizeof(struct ThreadWorker));
+    pthread_t *threads = malloc(pnum * sizeof(pthread_t));
+
+    struct Timeline *timeline = &result->timeline;
+    InitTimeline(timeline);
+
+    int started = 0;
+    int spawn_span = BeginSpan(timeline, "spawn", SPAN_NO_WORKER);
+    for (int i = 0; i < pnum; i++) {
+        workers[i].config = config;
+        workers[i].params = config->params;
+        workers[i].params.cancel = &cancel;
+        workers[i].queue = queue;
+        workers[i].slot = &slots[i];
+        workers[i].perf = perf_slots ? &perf_slots[i] : NULL;
+        workers[i].summary = summary_slots ? &summary_slots[i] : NULL;
+        workers[i].index = i;
+        workers[i].lock = &lock;
+        workers[i].done_cond = &done_cond;
+        workers[i].done = &done;
+        if (pthread_create(&threads[i], NULL, ThreadWorkerMain, &workers[i])) {
+            printf("Error: pthread_create failed!\n");
+            atomic_store(&cancel, 1);
+            break;
+        }
+        started++;
+    }
+    EndSpan(timeline, spawn_span);
+
+    // Ждем всех потоков или дедлайна
+    struct timespec deadline = DeadlineAfter(config->timeout);
+
+    int wait_span = BeginSpan(timeline, "wait", SPAN_NO_WORKER);
+    pthread_mutex_lock(&lock);
+    while (done < started && !result->timed_out) {
+        if (config->timeout > 0) {
+            if (pthread_cond_timedwait(&done_cond, &lock, &deadline) ==
+                    ETIMEDOUT &&
+                done < started) {
+                result->timed_out = true;
+            }
+        } else {
+            pthread_cond_wait(&done_cond, &lock);
+        }
+    }
+    pthread_mutex_unlock(&lock);
+
+    if (result->timed_out) {
+        atomic_store(&cancel, 1);
+        printf("Timeout occurred! Threads were cancelled\n");
+    }
+    for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    EndSpan(timeline, wait_span);
+
+    // Передачи нет: результаты уже в слотах, остается их объединить
+    int aggregate_span = BeginSpan(timeline, "aggregate", SPAN_NO_WORKER);
+    for (int i = 0; i < started; i++) {
+        struct MinMax worker;
+        bool result_read = ReadResult(&slots[i], &worker);
+        if (result_read) result->completed++;
+        CollectWorker(config, &slots[i], result_read, worker,
+                      summary_slots ? &summary_slots[i] : NULL, result);
+    }
+    EndSpan(timeline, aggregate_span);
+
+    result->collect_ms = SpanMs(timeline, aggregate_span);
+    result->elapsed_ms = (MonotonicNs() - timeline->origin_ns) / 1e6;
+    CollectStats(config, slots, result);
+    CollectPerf(config, perf_slots, result);
+
+    pthread_cond_destroy(&done_cond);
+    pthread_condattr_destroy(&cond_attr);
+    DestroyWorkerSlots(slots, pnum);
+    if (summary_slots) DestroySummarySlots(summary_slots, pnum);
+    if (queue) DestroyChunkQueue(queue);
+    free(workers);
+    free(threads);
+    return started == pnum ? 0 : -1;
+}
+
+// Квантили по слитому скетчу и точный top-k
+static void PrintSummary(const struct RunConfig *config,
+                         const struct RunResult *result) {
+    const struct ValueSummary *summary = result->summary;
+    if (summary == NULL || summary->count == 0) return;
+    if (result->timed_out) {
+        printf("Quantiles and top-k cover completed workers only\n");
+    }
+    for (int q = 0; q < config->quantile_count; q++) {
+        int value = SketchQuantile(&summary->sketch, config->quantiles[q]);
+        // Крайние квантили - это точные min и max
+        if (!result->timed_out && config->quantiles[q] == 0) {
+            value = result->min_max.min;
+        } else if (!result->timed_out && config->quantiles[q] == 1) {
+            value = result->min_max.max;
+        }
+        printf("Quantile %g: %d\n", config->quantiles[q], value);
+    }
+    if (config->top_k > 0) {
+        int top[MAX_TOP_K];
+        unsigned int count = SortedTopK(&summary->top, top);
+        printf("Top %u:", count);
+        for (unsigned int i = 0; i < count; i++) printf(" %d", top[i]);
+        printf("\n");
+    }
+}
+
+static void PrintResult(const struct RunConfig *config,
+                        const struct RunResult *result, const char *engine) {
+    const struct MinMax *min_max = &result->min_max;
+    size_t range_size = config->range_end - config->range_begin;
+
+    if (result->timed_out) {
+        printf("Execution terminated due to timeout after %g seconds\n",
+               config->timeout);
+        printf("Completed workers: %d/%d\n", result->completed, config->pnum);
+        if (config->track_progress) {
+            printf("Scanned elements: %lu/%zu (%.2f%%)\n", result->scanned,
+                   range_size, 100.0 * result->scanned / range_size);
+        }
+        if (min_max->min != INT_MAX && min_max->max != INT_MIN) {
+            printf("Partial results from completed work:\n");
+            printf("Min: %d\n", min_max->min);
+            printf("Max: %d\n", min_max->max);
         } else {
-            printf("No processes completed in time\n");
+            printf("No workers completed in time\n");
         }
+    } else if (min_max->min > min_max->max) {
+        printf("No elements match the filter\n");
     } else {
-        printf("Min: %d\n", min_max.min);
-        printf("Max: %d\n", min_max.max);
+        printf("Min: %d\n", min_max->min);
+        printf("Max: %d\n", min_max->max);
     }
-    
-    printf("Elapsed time: %fms\n", elapsed_time);
-    fflush(NULL);
-    return timeout_occurred ? 1 : 0;
-}
\ No newline at end of file
+    PrintSummary(config, result);
+
+    printf("Engine: %s\n", engine);
+    if (strcmp(engine, "processes") == 0) {
+        printf("Transport: %s\n", transport_names[config->transport]);
+    }
+    if (config->spawn != SPAWN_FORK) {
+        printf("Spawn: %s, dataset in %smemfd\n", SpawnMethodName(config->spawn),
+               config->memfd->sealed ? "sealed " : "");
+    }
+    if (config->chunk_size > 0) {
+        printf("Scheduler: dynamic, chunk size %d\n", config->chunk_size);
+    } else {
+        printf("Scheduler: static\n");
+    }
+    if (config->speculate > 0) {
+        printf("Speculation: %d backups launched, %d won\n", result->backups,
+               result->backups_won);
+    }
+    printf("Collect time: %fms\n", result->collect_ms);
+    printf("Elapsed time: %fms\n", result->elapsed_ms);
+    PrintTimeline(&result->timeline, config->timing, stdout);
+
+    // Отдельные воркеры статистику не публикуют
+    if (config->cpus && result->worker_elements) {
+        for (int i = 0; i < config->pnum; i++) {
+            printf("Worker %d: cpu %d, node %d, %lu elements, %.3fms\n", i,
+                   config->cpus[i], NodeOfCpu(config->topology, config->cpus[i]),
+                   result->worker_elements[i], result->worker_ms[i]);
+        }
+        PrintNodeBandwidth(config->topology, config->cpus, config->pnum,
+                           result->worker_elements, result->worker_ms,
+                           sizeof(int));
+    }
+
+    // Убитые по таймауту воркеры счетчики не публикуют, в сумму они не входят
+    if (result->worker_perf) {
+        struct PerfValues total;
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) total.value[c] = -1;
+        char label[32];
+        for (int i = 0; i < config->pnum; i++) {
+            snprintf(label, sizeof(label), "Perf worker %d", i);
+            PrintPerfValues(label, &result->worker_perf[i]);
+            AddPerfValues(&total, &result->worker_perf[i]);
+        }
+        PrintPerfValues("Perf total", &total);
+    }
+}
+
+// Прогон для массива не int32 (--type): статические сегменты, ядро по
+// типу, результаты воркеров в общей памяти
+struct TypedWorker {
+    const struct RunConfig *config;
+    enum ValueType type;
+    const void *array;
+    int index;
+    struct TypedMinMax *result;
+    // Только для потоков: отмена по таймауту и счетчик завершившихся
+    atomic_int *cancel;
+    bool completed;
+    pthread_mutex_t *lock;
+    pthread_cond_t *done_cond;
+    int *done;
+};
+
+static void *TypedWorkerMain(void *arg) {
+    struct TypedWorker *worker = (struct TypedWorker *)arg;
+    size_t begin, end;
+    WorkerSegment(worker->config, worker->index, &begin, &end);
+    if (worker->config->cpus) PinToCpu(worker->config->cpus[worker->index]);
+
+    // Блоками по CANCEL_BLOCK, чтобы поток замечал отмену
+    struct TypedMinMax local = EmptyTypedMinMax(worker->type);
+    while (begin < end) {
+        if (worker->cancel && atomic_load_explicit(worker->cancel,
+                                                   memory_order_relaxed)) {
+            break;
+        }
+        size_t stop = end - begin > CANCEL_BLOCK ? begin + CANCEL_BLOCK : end;
+        struct TypedMinMax block =
+            GetMinMaxTyped(worker->type, worker->array, begin, stop);
+        MergeTypedMinMax(&local, &block);
+        begin = stop;
+    }
+    if (begin == end) {
+        *worker->result = local;
+        worker->completed = true;
+    }
+
+    if (worker->lock) {
+        pthread_mutex_lock(worker->lock);
+        (*worker->done)++;
+        pthread_cond_signal(worker->done_cond);
+        pthread_mutex_unlock(worker->lock);
+    }
+    return NULL;
+}
+
+// Возвращает число воркеров, чьи результаты попали в *min_max, или -1
+static int RunTyped(const struct RunConfig *config, bool processes,
+                    enum ValueType type, const void *array,
+                    struct TypedMinMax *min_max, double *elapsed_ms,
+                    bool *timed_out) {
+    int pnum = config->pnum;
+    struct TypedMinMax *results = mmap(NULL, pnum * sizeof(struct TypedMinMax),
+                                       PROT_READ | PROT_WRITE,
+                                       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (results == MAP_FAILED) {
+        perror("mmap failed");
+        return -1;
+    }
+    struct TypedWorker *workers = malloc(pnum * sizeof(struct TypedWorker));
+    bool *finished = malloc(pnum * sizeof(bool));
+    atomic_int cancel;
+    atomic_init(&cancel, 0);
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    pthread_condattr_t cond_attr;
+    pthread_cond_t done_cond;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&done_cond, &cond_attr);
+    int done = 0;
+    for (int i = 0; i < pnum; i++) {
+        workers[i] = (struct TypedWorker){config, type, array, i, &results[i],
+                                          NULL, false, NULL, NULL, NULL};
+        if (!processes) {
+            workers[i].cancel = &cancel;
+            workers[i].lock = &lock;
+            workers[i].done_cond = &done_cond;
+            workers[i].done = &done;
+        }
+        finished[i] = false;
+    }
+
+    uint64_t start_ns = MonotonicNs();
+    int status = 0;
+    *timed_out = false;
+    if (processes) {
+        pid_t *pids = malloc(pnum * sizeof(pid_t));
+        int started = 0;
+        for (; started < pnum; started++) {
+            pids[started] = fork();
+            if (pids[started] == 0) {
+                TypedWorkerMain(&workers[started]);
+                _exit(0);
+            }
+            if (pids[started] == -1) {
+                perror("fork failed");
+                status = -1;
+                break;
+            }
+        }
+        if (SuperviseChildren(pids, started, config->timeout, finished,
+                              timed_out) == -1) {
+            status = -1;
+        }
+        free(pids);
+    } else {
+        pthread_t *threads = malloc(pnum * sizeof(pthread_t));
+        int started = 0;
+        for (; started < pnum; started++) {
+            if (pthread_create(&threads[started], NULL, TypedWorkerMain,
+                               &workers[started]) != 0) {
+                printf("Error: pthread_create failed!\n");
+                status = -1;
+                break;
+            }
+        }
+
+        // Как в RunThreads: ждем всех или дедлайна, затем отменяем
+        struct timespec deadline = DeadlineAfter(config->timeout);
+        pthread_mutex_lock(&lock);
+        while (done < started && !*timed_out) {
+            if (config->timeout > 0) {
+                if (pthread_cond_timedwait(&done_cond, &lock, &deadline) ==
+                        ETIMEDOUT &&
+                    done < started) {
+                    *timed_out = true;
+                }
+            } else {
+                pthread_cond_wait(&done_cond, &lock);
+            }
+        }
+        pthread_mutex_unlock(&lock);
+        atomic_store(&cancel, 1);
+        for (int i = 0; i < started; i++) {
+            pthread_join(threads[i], NULL);
+            finished[i] = workers[i].completed;
+        }
+        free(threads);
+    }
+    pthread_cond_destroy(&done_cond);
+    pthread_condattr_destroy(&cond_attr);
+    *elapsed_ms = (MonotonicNs() - start_ns) / 1e6;
+
+    int completed = 0;
+    *min_max = EmptyTypedMinMax(type);
+    for (int i = 0; i < pnum; i++) {
+        if (!finished[i]) continue;
+        MergeTypedMinMax(min_max, &results[i]);
+        completed++;
+    }
+    munmap(results, pnum * sizeof(struct TypedMinMax));
+    free(workers);
+    free(finished);
+    return status == -1 ? -1 : completed;
+}
+
+static void PrintTypedResult(const struct RunConfig *config,
+                             enum ValueType type,
+                             const struct TypedMinMax *min_max, int completed,
+                             double elapsed_ms, bool timed_out,
+                             const char *engine) {
+    size_t elements = config->range_end - config->range_begin;
+    char min[32], max[32];
+    FormatTypedValue(type, min_max->min, min, sizeof(min));
+    FormatTypedValue(type, min_max->max, max, sizeof(max));
+    bool empty = IsFloatType(type) ? !(min_max->min.f <= min_max->max.f)
+                                   : min_max->min.i > min_max->max.i;
+
+    if (timed_out) {
+        printf("Execution terminated due to timeout after %g seconds\n",
+               config->timeout);
+        printf("Completed workers: %d/%d\n", completed, config->pnum);
+    }
+    if (empty) {
+        if (timed_out) printf("No workers completed in time\n");
+        else printf("No elements to compare\n");
+    } else {
+        if (timed_out) printf("Partial results from completed work:\n");
+        printf("Min: %s\n", min);
+        printf("Max: %s\n", max);
+    }
+    if (IsFloatType(type)) {
+        printf("NaNs: %llu\n", (unsigned long long)min_max->nan_count);
+    }
+    printf("Engine: %s\n", engine);
+    printf("Type: %s, %zu elements per cache line\n", ValueTypeName(type),
+           64 / ValueTypeSize(type));
+    printf("Elapsed time: %fms\n", elapsed_ms);
+    // После таймаута просмотрена только часть диапазона
+    if (!timed_out) {
+        printf("Throughput: %.1f M elements/s, %.2f GB/s\n",
+               elements / elapsed_ms / 1e3,
+               elements * ValueTypeSize(type) / elapsed_ms / 1e6);
+    }
+}
+
+// main для --type: массив нужного типа из генератора или из файла,
+// затем один или оба движка, как и для int32
+static int RunTypedMain(enum ValueType type, const char *input,
+                        int dataset_flags, int seed, size_t array_size,
+                        bool hugetlb, bool with_range, size_t range_begin,
+                        size_t range_end, int pnum, double timeout,
+                        enum Mode mode, const struct Topology *topology,
+                        const int *cpus) {
+    struct Dataset dataset = {0};
+    void *array = NULL;
+    enum PageKind pages = PAGES_NORMAL;
+    size_t element_size = ValueTypeSize(type);
+    if (input != NULL) {
+        if (OpenDataset(input, dataset_flags, &dataset) == -1) return 1;
+        if (dataset.type != ValueTypeElement(type) || dataset.count == 0) {
+            printf("Input must hold %s elements\n", ValueTypeName(type));
+            CloseDataset(&dataset);
+            return 1;
+        }
+        array = dataset.data;
+        array_size = dataset.count;
+    } else {
+        array = AllocateLarge(element_size * array_size, hugetlb, &pages);
+        if (array == NULL) {
+            perror("mmap failed");
+            return 1;
+        }
+        GenerateTypedArray(type, array, array_size, seed);
+    }
+
+    int status = 0;
+    if (with_range && range_end > array_size) {
+        printf("Range is out of array bounds\n");
+        status = 1;
+    }
+    if (!with_range) {
+        range_begin = 0;
+        range_end = array_size;
+    }
+
+    struct RunConfig config;
+    memset(&config, 0, sizeof(config));
+    config.range_begin = range_begin;
+    config.range_end = range_end;
+    config.pnum = pnum;
+    config.timeout = timeout;
+    config.topology = topology;
+    config.cpus = cpus;
+
+    if (timeout > 0 && status == 0) {
+        printf("Timeout set to %g seconds\n", timeout);
+    }
+    const char *engines[2];
+    double elapsed[2];
+    int runs = 0;
+    for (int e = 0; e < 2 && status == 0; e++) {
+        bool processes = e == 0;
+        if ((processes && mode == MODE_THREADS) ||
+            (!processes && mode == MODE_PROCESSES)) {
+            continue;
+        }
+        struct TypedMinMax min_max;
+        bool timed_out;
+        int completed = RunTyped(&config, processes, type, array, &min_max,
+                                 &elapsed[runs], &timed_out);
+        if (completed == -1) {
+            status = 1;
+            break;
+        }
+        engines[runs] = processes ? "processes" : "threads";
+        PrintTypedResult(&config, type, &min_max, completed, elapsed[runs],
+                         timed_out, engines[runs]);
+        if (timed_out) status = 1;
+        runs++;
+    }
+
+    if (mode == MODE_COMPARE && runs == 2) {
+        printf("\n%-10s %14s\n", "engine", "elapsed ms");
+        for (int r = 0; r < runs; r++) {
+            printf("%-10s %14.3f\n", engines[r], elapsed[r]);
+        }
+        printf("Fastest: %s\n", elapsed[0] <= elapsed[1] ? engines[0] : engines[1]);
+    }
+    if (input == NULL) {
+        printf("Pages: %s\n", PageKindName(pages));
+        FreeLarge(array, element_size * array_size);
+    } else {
+        CloseDataset(&dataset);
+    }
+    fflush(NULL);
+    return status;
+}
+
+static void ReleaseArray(struct Dataset *dataset, int *array,
+                         size_t array_size) {
+    if (dataset->map != NULL) {
+        CloseDataset(dataset);
+    } else {
+        FreeLarge(array, sizeof(int) * array_size);
+    }
+}
+
+static volatile sig_atomic_t stop_serving = 0;
+
+static void StopServing(int sig) {
+    (void)sig;
+    stop_serving = 1;
+}
+
+// Режим пула: воркеры запускаются один раз и обслуживают запросы
+// "offset length [dataset]" со stdin или с UNIX-сокета socket_path
+static int RunPool(int *array, size_t array_size, int pnum,
+                   const char *socket_path) {
+    // Протокол пула и его кольцо задач пока 32-битные
+    if (array_size > UINT_MAX) {
+        printf("Pool mode supports at most %u elements\n", UINT_MAX);
+        return 1;
+    }
+    struct PoolDataset dataset = {array, (unsigned int)array_size};
+    struct WorkerPool *pool = CreateWorkerPool(pnum, &dataset, 1);
+    if (pool == NULL) {
+        printf("Failed to start worker pool\n");
+        return 1;
+    }
+
+    long served = 0;
+    double total_latency = 0;
+    if (socket_path == NULL) {
+        served = ServeQueries(pool, stdin, stdout, &total_latency);
+    } else {
+        int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_un addr = {0};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+        unlink(socket_path);
+        if (listen_fd == -1 ||
+            bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+            listen(listen_fd, 16) == -1) {
+            perror("socket failed");
+            DestroyWorkerPool(pool);
+            return 1;
+        }
+
+        // Без SA_RESTART: SIGINT/SIGTERM прерывают accept и завершают сервер
+        struct sigaction sa = {0};
+        sa.sa_handler = StopServing;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGINT, &sa, NULL);
+        sigaction(SIGTERM, &sa, NULL);
+
+        printf("Serving queries on %s\n", socket_path);
+        fflush(stdout);
+        while (!stop_serving && PoolAlive(pool)) {
+            int client = accept(listen_fd, NULL, NULL);
+            if (client == -1) continue;
+            FILE *in = fdopen(client, "r");
+            FILE *out = fdopen(dup(client), "w");
+            served += ServeQueries(pool, in, out, &total_latency);
+            fclose(in);
+            fclose(out);
+        }
+        close(listen_fd);
+        unlink(socket_path);
+    }
+
+    bool alive = PoolAlive(pool);
+    DestroyWorkerPool(pool);
+    printf("Queries: %ld\n", served);
+    if (served > 0) {
+        printf("Average latency: %fus\n", total_latency / served);
+    }
+    if (!alive) {
+        printf("Worker pool failed\n");
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int seed = -1;
+    size_t array_size = 0;
+    int pnum = -1;
+    double timeout = 0;
+    enum Transport transport = TRANSPORT_PIPE;
+    int chunk_size = 0;
+    int checkpoint = -1;
+    const char *input = NULL;
+    int dataset_flags = 0;
+    bool pool_mode = false;
+    const char *socket_path = NULL;
+    int zone_size = 0;
+    bool with_range = false;
+    size_t range_begin = 0, range_end = 0;
+    bool with_filter = false;
+    struct ValueFilter filter = {INT_MIN, INT_MAX};
+    enum Mode mode = MODE_PROCESSES;
+    enum PinPolicy pin_policy = PIN_NONE;
+    bool numa = false;
+    bool hugetlb = false;
+    bool perf = false;
+    enum TimingFormat timing = TIMING_NONE;
+    double quantiles[MAX_QUANTILES];
+    int quantile_count = 0;
+    int top_k = 0;
+    double speculate = 0;
+    enum SpawnMethod spawn = SPAWN_FORK;
+    bool seal = false;
+    const char *worker_path = NULL;
+    enum ValueType type = VALUE_INT32;
+
+    while (true) {
+        int current_optind = optind ? optind : 1;
+
+        static struct option options[] = {{"seed", required_argument, 0, 0},
+                                          {"array_size", required_argument, 0, 0},
+                                          {"pnum", required_argument, 0, 0},
+                                          {"timeout", required_argument, 0, 0},
+                                          {"by_files", no_argument, 0, 'f'},
+                                          {"by_shm", no_argument, 0, 0},
+                                          {"chunk_size", required_argument, 0, 0},
+                                          {"checkpoint", required_argument, 0, 0},
+                                          {"input", required_argument, 0, 0},
+                                          {"populate", no_argument, 0, 0},
+                                          {"sequential", no_argument, 0, 0},
+                                          {"pool", no_argument, 0, 0},
+                                          {"pool_socket", required_argument, 0, 0},
+                                          {"zone_size", required_argument, 0, 0},
+                                          {"range", required_argument, 0, 0},
+                                          {"where", required_argument, 0, 0},
+                                          {"mode", required_argument, 0, 0},
+                                          {"pin", required_argument, 0, 0},
+                                          {"numa", no_argument, 0, 0},
+                                          {"hugetlb", no_argument, 0, 0},
+                                          {"perf", no_argument, 0, 0},
+                                          {"timing", required_argument, 0, 0},
+                                          {"quantiles", required_argument, 0, 0},
+                                          {"top_k", required_argument, 0, 0},
+                                          {"speculate", required_argument, 0, 0},
+                                          {"spawn", required_argument, 0, 0},
+                                          {"seal", no_argument, 0, 0},
+                                          {"worker", required_argument, 0, 0},
+                                          {"type", required_argument, 0, 0},
+                                          {0, 0, 0, 0}};
+
+        int option_index = 0;
+        int c = getopt_long(argc, argv, "f", options, &option_index);
+
+        if (c == -1) break;
+
+        switch (c) {
+            case 0:
+                switch (option_index) {
+                    case 0:
+                        seed = atoi(optarg);
+                        if (seed <= 0) {
+                            printf("Seed must be a positive number\n");
+                            return 1;
+                        }
+                        break;
+                    case 1:
+                        if (atoll(optarg) <= 0) {
+                            printf("Array size must be a positive number\n");
+                            return 1;
+                        }
+                        array_size = (size_t)atoll(optarg);
+                        break;
+                    case 2:
+                        pnum = atoi(optarg);
+                        if (pnum <= 0) {
+                            printf("Process number must be a positive number\n");
+                            return 1;
+                        }
+                        break;
+                    case 3:
+                        timeout = atof(optarg);
+                        if (timeout <= 0) {
+                            printf("Timeout must be a positive number\n");
+                            return 1;
+                        }
+                        break;
+                    case 4:
+                        transport = TRANSPORT_FILES;
+                        break;
+                    case 5:
+                        transport = TRANSPORT_SHM;
+                        break;
+                    case 6:
+                        chunk_size = atoi(optarg);
+                        if (chunk_size <= 0) {
+                            printf("Chunk size must be a positive number\n");
+                            return 1;
+                        }
+                        break;
+                    case 7:
+                        checkpoint = atoi(optarg);
+                        if (checkpoint < 0) {
+                            printf("Checkpoint must be a non-negative number\n");
+                            return 1;
+                        }
+                        break;
+                    case 8:
+                        input = optarg;
+                        break;
+                    case 9:
+                        dataset_flags |= DATASET_POPULATE;
+                        break;
+                    case 10:
+                        dataset_flags |= DATASET_SEQUENTIAL;
+                        break;
+                    case 11:
+                        pool_mode = true;
+                        break;
+                    case 12:
+                        pool_mode = true;
+                        socket_path = optarg;
+                        break;
+                    case 13:
+                        zone_size = atoi(optarg);
+                        if (zone_size <= 0) {
+                            printf("Zone size must be a positive number\n");
+                            return 1;
+                        }
+                        break;
+                    case 14:
+                        if (sscanf(optarg, "%zu:%zu", &range_begin, &range_end) != 2 ||
+                            range_begin >= range_end) {
+                            printf("Range must be \"begin:end\" with begin < end\n");
+                            return 1;
+                        }
+                        with_range = true;
+                        break;
+                    case 15:
+                        if (sscanf(optarg, "%d:%d", &filter.lo, &filter.hi) != 2 ||
+                            filter.lo > filter.hi) {
+                            printf("Filter must be \"lo:hi\" with lo <= hi\n");
+                            return 1;
+                        }
+                        with_filter = true;
+                        break;
+                    case 16:
+                        if (strcmp(optarg, "processes") == 0) {
+                            mode = MODE_PROCESSES;
+                        } else if (strcmp(optarg, "threads") == 0) {
+                            mode = MODE_THREADS;
+                        } else if (strcmp(optarg, "compare") == 0) {
+                            mode = MODE_COMPARE;
+                        } else {
+                            printf("Mode must be processes, threads or compare\n");
+                            return 1;
+                        }
+                        break;
+                    case 17:
+                        if (ParsePinPolicy(optarg, &pin_policy) == -1) {
+                            printf("Pin policy must be none, compact, scatter or smt-avoid\n");
+                            return 1;
+                        }
+                        break;
+                    case 18:
+                        numa = true;
+                        break;
+                    case 19:
+                        hugetlb = true;
+                        break;
+                    case 20:
+                        perf = true;
+                        break;
+                    case 21:
+                        if (ParseTimingFormat(optarg, &timing) == -1) {
+                            printf("Timing format must be none, text or json\n");
+                            return 1;
+                        }
+                        break;
+                    case 22: {
+                        char *rest = optarg;
+                        quantile_count = 0;
+                        while (*rest != '\0') {
+                            char *end;
+                            double q = strtod(rest, &end);
+                            if (end == rest || q < 0 || q > 1 ||
+                                quantile_count == MAX_QUANTILES ||
+                                (*end != ',' && *end != '\0')) {
+                                printf("Quantiles must be up to %d comma-separated values in [0, 1]\n",
+                                       MAX_QUANTILES);
+                                return 1;
+                            }
+                            quantiles[quantile_count++] = q;
+                            rest = *end == ',' ? end + 1 : end;
+                        }
+                        break;
+                    }
+                    case 23:
+                        top_k = atoi(optarg);
+                        if (top_k <= 0 || top_k > MAX_TOP_K) {
+                            printf("Top-k must be between 1 and %d\n", MAX_TOP_K);
+                            return 1;
+                        }
+                        break;
+                    case 24:
+                        speculate = atof(optarg);
+                        if (speculate < 1) {
+                            printf("Speculation threshold must be at least 1\n");
+                            return 1;
+                        }
+                        break;
+                    case 25:
+                        if (ParseSpawnMethod(optarg, &spawn) == -1) {
+                            printf("Spawn method must be fork, exec or posix_spawn\n");
+                            return 1;
+                        }
+                        break;
+                    case 26:
+                        seal = true;
+                        break;
+                    case 27:
+                        worker_path = optarg;
+                        break;
+                    case 28:
+                        if (ParseValueType(optarg, &type) == -1) {
+                            printf("Type must be int8, int16, int32, int64, float or double\n");
+                            return 1;
+                        }
+                        break;
+
+                    default:
+                        printf("Index %d is out of options\n", option_index);
+                }
+                break;
+            case 'f':
+                transport = TRANSPORT_FILES;
+                break;
+
+            case '?':
+                break;
+
+            default:
+                printf("getopt returned character code 0%o?\n", c);
+        }
+    }
+
+    if (optind < argc) {
+        printf("Has at least one no option argument\n");
+        return 1;
+    }
+
+    if ((input == NULL && (seed == -1 || array_size == 0)) || pnum == -1) {
+        printf("Usage: %s {--seed \"num\" --array_size \"num\" | --input \"file\" [--populate] [--sequential]} --pnum \"num\" [--timeout \"num\"] [--by_files | --by_shm] [--chunk_size \"num\"] [--checkpoint \"num\"] [--pool | --pool_socket \"path\"] [--zone_size \"num\"] [--range \"begin:end\"] [--where \"lo:hi\"] [--mode processes|threads|compare] [--pin compact|scatter|smt-avoid] [--numa] [--hugetlb] [--perf] [--timing text|json] [--quantiles \"q,...\"] [--top_k \"num\"] [--speculate \"ratio\"] [--spawn fork|exec|posix_spawn [--seal] [--worker \"path\"]] [--type int8|int16|int32|int64|float|double]\n",
+               argv[0]);
+        return 1;
+    }
+
+    // Остаток отстающего - непрерывный хвост его статического сегмента, а
+    // сводку по частям двух процессов не собрать
+    if (speculate > 0 && (mode != MODE_PROCESSES || chunk_size > 0 ||
+                          quantile_count > 0 || top_k > 0)) {
+        printf("Speculation requires the processes engine with static scheduling and no quantiles or top-k\n");
+        return 1;
+    }
+
+    // Отдельному воркеру передаются только срез, фильтр и CPU, результат -
+    // через его stdout
+    if (spawn != SPAWN_FORK &&
+        (mode != MODE_PROCESSES || pool_mode || transport != TRANSPORT_PIPE ||
+         chunk_size > 0 || zone_size > 0 || quantile_count > 0 || top_k > 0 ||
+         numa || perf || speculate > 0)) {
+        printf("Exec'd workers support the processes engine with pipes and static scheduling only\n");
+        return 1;
+    }
+    // Ядра других типов считают только min/max (и NaN) статических сегментов
+    if (type != VALUE_INT32 &&
+        (pool_mode || transport != TRANSPORT_PIPE || chunk_size > 0 ||
+         checkpoint > 0 || zone_size > 0 || with_filter ||
+         quantile_count > 0 || top_k > 0 || speculate > 0 ||
+         spawn != SPAWN_FORK || numa || perf)) {
+        printf("Types other than int32 support plain min/max with static scheduling only\n");
+        return 1;
+    }
+    if (seal && spawn == SPAWN_FORK) {
+        printf("Sealing applies to exec'd workers only\n");
+        return 1;
+    }
+    // По умолчанию воркер лежит рядом с parallel_min_max
+    char default_worker[PATH_MAX];
+    if (worker_path == NULL) {
+        const char *slash = strrchr(argv[0], '/');
+        snprintf(default_worker, sizeof(default_worker), "%.*smin_max_worker",
+                 slash ? (int)(slash - argv[0] + 1) : 0, argv[0]);
+        worker_path = default_worker;
+    }
+
+    // Топология нужна и для привязки воркеров, и для размещения массива;
+    // --numa без политики раскладывает воркеров по узлам (scatter)
+    struct Topology topology = {0};
+    int *cpus = NULL;
+    if (numa && pin_policy == PIN_NONE) pin_policy = PIN_SCATTER;
+    if (pin_policy != PIN_NONE) {
+        if (LoadTopology(&topology) == -1) {
+            perror("sched_getaffinity failed");
+            return 1;
+        }
+        cpus = malloc(pnum * sizeof(int));
+        PlanPlacement(&topology, pin_policy, pnum, cpus);
+    }
+
+    if (type != VALUE_INT32) {
+        int status = RunTypedMain(type, input, dataset_flags, seed, array_size,
+                                  hugetlb, with_range, range_begin, range_end,
+                                  pnum, timeout, mode, &topology, cpus);
+        free(cpus);
+        FreeTopology(&topology);
+        return status;
+    }
+
+    // Массив либо генерируется, либо отображается из файла без копирования
+    struct Dataset dataset = {0};
+    struct MemfdDataset memfd = {0};
+    int *array = NULL;
+    enum PageKind pages = PAGES_NORMAL;
+    if (input != NULL) {
+        if (OpenDataset(input, dataset_flags, &dataset) == -1) return 1;
+        if (dataset.type != ELEMENT_INT32 || dataset.count == 0) {
+            printf("Input must hold int32 elements\n");
+            return 1;
+        }
+        array = (int *)dataset.data;
+        array_size = dataset.count;
+    }
+    if (spawn != SPAWN_FORK) {
+        // Для отдельных воркеров массив лежит в memfd; карта зон файла им
+        // не передается
+        if (CreateMemfdDataset(&memfd, array_size) == -1) return 1;
+        if (input != NULL) {
+            memcpy(memfd.data, array, sizeof(int) * array_size);
+            CloseDataset(&dataset);
+        } else {
+            GenerateArray(memfd.data, array_size, seed);
+        }
+        if (seal && SealMemfdDataset(&memfd) == -1) return 1;
+        array = memfd.data;
+    } else if (input == NULL) {
+        array = AllocateLarge(sizeof(int) * array_size, hugetlb, &pages);
+        if (array == NULL) {
+            perror("mmap failed");
+            return 1;
+        }
+        // Страницы еще не тронуты: с --numa каждый сегмент привязывается к
+        // узлу своего воркера и заполняется на его CPU (first touch)
+        if (numa) {
+            GeneratePlaced(&topology, cpus, pnum, array, array_size, seed);
+        } else {
+            GenerateArray(array, array_size, seed);
+        }
+    }
+    if (numa && input != NULL) {
+        printf("NUMA placement applies to generated arrays only\n");
+    }
+
+    if (pool_mode) {
+        int result = RunPool(array, array_size, pnum, socket_path);
+        ReleaseArray(&dataset, array, array_size);
+        free(cpus);
+        FreeTopology(&topology);
+        return result;
+    }
+
+    if (with_range && range_end > array_size) {
+        printf("Range is out of array bounds\n");
+        return 1;
+    }
+    if (!with_range) {
+        range_begin = 0;
+        range_end = array_size;
+    }
+
+    // Карта зон: из файла, если она там есть, иначе строим по --zone_size
+    struct ZoneMap zones = {0};
+    bool with_zones = false;
+    if (input != NULL && spawn == SPAWN_FORK &&
+        ZoneMapFromDataset(&zones, &dataset) == 0) {
+        with_zones = true;
+    } else if (zone_size > 0) {
+        if (BuildZoneMap(&zones, array, array_size, zone_size, 0) == -1) {
+            printf("Failed to build zone map\n");
+            return 1;
+        }
+        with_zones = true;
+    }
+
+    struct ScanParams params;
+    params.array = array;
+    params.zones = with_zones ? &zones : NULL;
+    params.filter = with_filter ? &filter : NULL;
+    params.offset = range_begin;
+    params.cancel = NULL;
+
+    if (timeout > 0) {
+        printf("Timeout set to %g seconds\n", timeout);
+    }
+
+    // С таймаутом воркеры по умолчанию сохраняют прогресс каждые
+    // DEFAULT_CHECKPOINT элементов, чтобы ответ был и для недосчитанных
+    // частей; при --speculate по прогрессу ищутся отстающие
+    if (checkpoint == -1) {
+        checkpoint = timeout > 0 || speculate > 0 ? DEFAULT_CHECKPOINT : 0;
+    }
+    bool track_progress = chunk_size > 0 || checkpoint > 0;
+    params.checkpoint = checkpoint;
+
+    struct RunConfig config;
+    config.params = params;
+    config.range_begin = range_begin;
+    config.range_end = range_end;
+    config.pnum = pnum;
+    config.timeout = timeout;
+    config.transport = transport;
+    config.chunk_size = chunk_size;
+    config.track_progress = track_progress;
+    config.topology = &topology;
+    config.cpus = cpus;
+    config.perf = perf;
+    config.timing = timing;
+    config.quantiles = quantiles;
+    config.quantile_count = quantile_count;
+    config.top_k = top_k;
+    config.speculate = speculate;
+    config.spawn = spawn;
+    config.memfd = &memfd;
+    config.worker_path = worker_path;
+
+    // В режиме сравнения один и тот же запрос выполняется обоими движками
+    struct RunResult results[2];
+    const char *engines[2];
+    int runs = 0;
+    int status = 0;
+    if (mode != MODE_THREADS) {
+        engines[runs] = "processes";
+        if (RunProcesses(&config, &results[runs]) == -1) {
+            status = 1;
+        } else {
+            PrintResult(&config, &results[runs], engines[runs]);
+            runs++;
+        }
+    }
+    if (mode != MODE_PROCESSES && status == 0) {
+        engines[runs] = "threads";
+        if (RunThreads(&config, &results[runs]) == -1) {
+            status = 1;
+        } else {
+            PrintResult(&config, &results[runs], engines[runs]);
+            runs++;
+        }
+    }
+
+    if (mode == MODE_COMPARE && runs == 2) {
+        printf("\n%-10s %14s %14s\n", "engine", "elapsed ms", "collect ms");
+        for (int r = 0; r < runs; r++) {
+            printf("%-10s %14.3f %14.3f\n", engines[r], results[r].elapsed_ms,
+                   results[r].collect_ms);
+        }
+        printf("Fastest: %s\n",
+               results[0].elapsed_ms <= results[1].elapsed_ms ? engines[0]
+                                                              : engines[1]);
+    }
+    if (with_zones) {
+        printf("Zone map: %u zones of %u elements\n", zones.zone_count,
+               zones.zone_size);
+    }
+
+    FreeZoneMap(&zones);
+    if (pin_policy != PIN_NONE) {
+        printf("Placement: %s%s\n", PinPolicyName(pin_policy),
+               numa && input == NULL ? ", NUMA first touch" : "");
+    }
+    if (input == NULL && spawn == SPAWN_FORK) {
+        printf("Pages: %s\n", PageKindName(pages));
+    }
+    if (spawn != SPAWN_FORK) CloseMemfdDataset(&memfd);
+    else ReleaseArray(&dataset, array, array_size);
+    free(cpus);
+    FreeTopology(&topology);
+
+    for (int r = 0; r < runs; r++) {
+        if (results[r].timed_out) status = 1;
+        FreeRunResult(&results[r]);
+    }
+    fflush(NULL);
+    return status;
+}
@@ -0,0 +1,295 @@
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "dataset.h"
+#include "perf_counters.h"
+#include "reduce.h"
+#include "reducers.h"
+#include "timing.h"
+#include "topology.h"
+#include "utils.h"
+#include "zone_map.h"
+
+#define MAX_REDUCERS 8
+
+// Несколько сверток одного массива за один проход общим движком:
+// --reduce min_max,sum,count,histogram,radix на процессах или потоках
+int main(int argc, char **argv) {
+    int seed = -1;
+    size_t array_size = 0;
+    int workers = 0;
+    enum ReduceBackend backend = REDUCE_THREADS;
+    char default_reduce[] = "min_max,sum,count";
+    char *reduce = default_reduce;
+    bool with_filter = false;
+    struct ValueFilter filter = {INT_MIN, INT_MAX};
+    const char *input = NULL;
+    int dataset_flags = 0;
+    enum PinPolicy pin_policy = PIN_NONE;
+    bool perf = false;
+    enum TimingFormat timing = TIMING_NONE;
+    unsigned int buckets = 16;
+    enum HistogramScale scale = HISTOGRAM_LINEAR;
+    bool with_bounds = false;
+    int bounds_lo = 0, bounds_hi = 0;
+
+    static struct option options[] = {
+        {"seed", required_argument, 0, 0},
+        {"array_size", required_argument, 0, 0},
+        {"workers", required_argument, 0, 0},
+        {"backend", required_argument, 0, 0},
+        {"reduce", required_argument, 0, 0},
+        {"where", required_argument, 0, 0},
+        {"input", required_argument, 0, 0},
+        {"populate", no_argument, 0, 0},
+        {"sequential", no_argument, 0, 0},
+        {"pin", required_argument, 0, 0},
+        {"perf", no_argument, 0, 0},
+        {"timing", required_argument, 0, 0},
+        {"buckets", required_argument, 0, 0},
+        {"scale", required_argument, 0, 0},
+        {"bounds", required_argument, 0, 0},
+        {0, 0, 0, 0}
+    };
+
+    int option_index = 0;
+    while (true) {
+        int c = getopt_long(argc, argv, "", options, &option_index);
+        if (c == -1) break;
+
+        switch (c) {
+            case 0:
+                switch (option_index) {
+                    case 0:
+                        seed = atoi(optarg);
+                        if (seed <= 0) {
+                            printf("Seed must be a positive number\n");
+                            return 1;
+                        }
+                        break;
+                    case 1:
+                        if (atoll(optarg) <= 0) {
+                            printf("Array size must be a positive number\n");
+                            return 1;
+                        }
+                        array_size = (size_t)atoll(optarg);
+                        break;
+                    case 2:
+                        workers = atoi(optarg);
+                        if (workers <= 0) {
+                            printf("Workers number must be a positive number\n");
+                            return 1;
+                        }
+                        break;
+                    case 3:
+                        if (ParseReduceBackend(optarg, &backend) == -1) {
+                            printf("Backend must be processes or threads\n");
+                            return 1;
+                        }
+                        break;
+                    case 4:
+                        reduce = optarg;
+                        break;
+                    case 5:
+                        if (sscanf(optarg, "%d:%d", &filter.lo, &filter.hi) != 2 ||
+                            filter.lo > filter.hi) {
+                            printf("Filter must be \"lo:hi\" with lo <= hi\n");
+                            return 1;
+                        }
+                        with_filter = true;
+                        break;
+                    case 6:
+                        input = optarg;
+                        break;
+                    case 7:
+                        dataset_flags |= DATASET_POPULATE;
+                        break;
+                    case 8:
+                        dataset_flags |= DATASET_SEQUENTIAL;
+                        break;
+                    case 9:
+                        if (ParsePinPolicy(optarg, &pin_policy) == -1) {
+                            printf("Pin policy must be none, compact, scatter or smt-avoid\n");
+                            return 1;
+                        }
+                        break;
+                    case 10:
+                        perf = true;
+                        break;
+                    case 11:
+                        if (ParseTimingFormat(optarg, &timing) == -1) {
+                            printf("Timing format must be none, text or json\n");
+                            return 1;
+                        }
+                        break;
+                    case 12:
+                        if (atoi(optarg) <= 0 || atoi(optarg) > HISTOGRAM_MAX_BUCKETS) {
+                            printf("Buckets must be between 1 and %d\n",
+                                   HISTOGRAM_MAX_BUCKETS);
+                            return 1;
+                        }
+                        buckets = atoi(optarg);
+                        break;
+                    case 13:
+                        if (strcmp(optarg, "linear") == 0) {
+                            scale = HISTOGRAM_LINEAR;
+                        } else if (strcmp(optarg, "log") == 0) {
+                            scale = HISTOGRAM_LOG;
+                        } else {
+                            printf("Scale must be linear or log\n");
+                            return 1;
+                        }
+                        break;
+                    case 14:
+                        if (sscanf(optarg, "%d:%d", &bounds_lo, &bounds_hi) != 2 ||
+                            bounds_lo > bounds_hi) {
+                            printf("Bounds must be \"lo:hi\" with lo <= hi\n");
+                            return 1;
+                        }
+                        with_bounds = true;
+                        break;
+                }
+                break;
+            case '?':
+                break;
+            default:
+                printf("getopt returned character code 0%o?\n", c);
+        }
+    }
+
+    if (workers == 0 || (input == NULL && (seed == -1 || array_size == 0))) {
+        printf("Usage: %s --workers \"num\" {--seed \"num\" --array_size \"num\" | --input \"file\" [--populate] [--sequential]} [--backend processes|threads] [--reduce min_max,sum,count,histogram,radix] [--where \"lo:hi\"] [--buckets \"num\"] [--scale linear|log] [--bounds \"lo:hi\"] [--pin compact|scatter|smt-avoid] [--perf] [--timing text|json]\n",
+               argv[0]);
+        return 1;
+    }
+
+    // Список сверток; фильтр --where относится к count, корзины - к histogram
+    struct ReduceOp ops[MAX_REDUCERS];
+    struct HistogramSpec histogram;
+    bool with_histogram = false;
+    int op_count = 0;
+    for (char *name = strtok(reduce, ","); name != NULL;
+         name = strtok(NULL, ",")) {
+        const struct Reducer *reducer = FindReducer(name);
+        if (reducer == NULL || op_count == MAX_REDUCERS) {
+            printf("Unknown reducer \"%s\" or more than %d reducers\n", name,
+                   MAX_REDUCERS);
+            return 1;
+        }
+        ops[op_count].reducer = reducer;
+        ops[op_count].arg = reducer == &count_reducer && with_filter ? &filter
+                                                                     : NULL;
+        if (reducer == &histogram_reducer) {
+            ops[op_count].arg = &histogram;
+            with_histogram = true;
+        }
+        op_count++;
+    }
+    if (op_count == 0) {
+        printf("At least one reducer is required\n");
+        return 1;
+    }
+
+    struct Topology topology = {0};
+    int *cpus = NULL;
+    if (pin_policy != PIN_NONE) {
+        if (LoadTopology(&topology) == -1) {
+            perror("sched_getaffinity failed");
+            return 1;
+        }
+        cpus = malloc(workers * sizeof(int));
+        PlanPlacement(&topology, pin_policy, workers, cpus);
+    }
+
+    // Генерация массива или отображение файла (не входит в замер времени)
+    struct Dataset dataset = {0};
+    int *array = NULL;
+    enum PageKind pages = PAGES_NORMAL;
+    if (input != NULL) {
+        if (OpenDataset(input, dataset_flags, &dataset) == -1) return 1;
+        if (dataset.type != ELEMENT_INT32 || dataset.count == 0) {
+            printf("Input must hold int32 elements\n");
+            return 1;
+        }
+        array = (int *)dataset.data;
+        array_size = dataset.count;
+    } else {
+        array = AllocateLarge(sizeof(int) * array_size, false, &pages);
+        if (array == NULL) {
+            perror("mmap failed");
+            return 1;
+        }
+        GenerateArray(array, array_size, seed);
+    }
+
+    // Без --bounds границы гистограммы - min и max массива, это отдельный
+    // проход до замера
+    struct ReduceConfig config = {backend, workers, cpus, perf, NULL};
+    if (with_histogram && !with_bounds) {
+        struct ReduceOp min_max_op = {&min_max_reducer, NULL};
+        struct ReduceResult bounds;
+        if (RunReduction(&config, array, array_size, &min_max_op, 1, &bounds) == -1) {
+            return 1;
+        }
+        bounds_lo = ((struct MinMax *)bounds.states[0])->min;
+        bounds_hi = ((struct MinMax *)bounds.states[0])->max;
+        FreeReduceResult(&bounds);
+    }
+    if (with_histogram &&
+        InitHistogramSpec(&histogram, scale, bounds_lo, bounds_hi, buckets) == -1) {
+        printf("Bounds [%d, %d] hold fewer values than %u buckets\n", bounds_lo,
+               bounds_hi, buckets);
+        return 1;
+    }
+
+    struct Timeline timeline;
+    InitTimeline(&timeline);
+    config.timeline = &timeline;
+    struct ReduceResult result;
+    int status = RunReduction(&config, array, array_size, ops, op_count, &result);
+    double elapsed_time = (MonotonicNs() - timeline.origin_ns) / 1e6;
+
+    if (status == 0) {
+        for (int i = 0; i < op_count; i++) {
+            ops[i].reducer->print(result.states[i], ops[i].arg);
+        }
+        printf("Backend: %s\n", ReduceBackendName(backend));
+        printf("Reducers: %d in one pass\n", op_count);
+        printf("Elapsed time: %f ms\n", elapsed_time);
+        PrintTimeline(&timeline, timing, stdout);
+
+        if (cpus) {
+            for (int i = 0; i < workers; i++) {
+                printf("Worker %d: cpu %d, node %d, %zu elements, %.3fms\n", i,
+                       cpus[i], NodeOfCpu(&topology, cpus[i]),
+                       result.stats[i].elements,
+                       (result.stats[i].finished_ns - result.stats[i].started_ns) / 1e6);
+            }
+            printf("Placement: %s\n", PinPolicyName(pin_policy));
+        }
+        if (perf) {
+            struct PerfValues total;
+            for (int c = 0; c < PERF_COUNTER_COUNT; c++) total.value[c] = -1;
+            char label[32];
+            for (int i = 0; i < workers; i++) {
+                snprintf(label, sizeof(label), "Perf worker %d", i);
+                PrintPerfValues(label, &result.stats[i].perf);
+                AddPerfValues(&total, &result.stats[i].perf);
+            }
+            PrintPerfValues("Perf total", &total);
+        }
+        FreeReduceResult(&result);
+    }
+    FreeTimeline(&timeline);
+
+    if (input != NULL) CloseDataset(&dataset);
+    else FreeLarge(array, sizeof(int) * array_size);
+    free(cpus);
+    FreeTopology(&topology);
+    return status == 0 ? 0 : 1;
+}
@@ -0,0 +1,309 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+
+#include "dataset.h"
+#include "reduce.h"
+#include "reducers.h"
+#include "sort_lib.h"
+#include "timing.h"
+#include "utils.h"
+#include "zone_map.h"
+
+enum SortAlgorithm { SORT_RADIX, SORT_SAMPLE, SORT_MERGE };
+
+static const char *AlgorithmName(enum SortAlgorithm algorithm) {
+    switch (algorithm) {
+        case SORT_RADIX: return "radix";
+        case SORT_SAMPLE: return "sample";
+        default: return "merge";
+    }
+}
+
+static int CompareInts(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Буфер сортировки в файле: отображение MAP_SHARED, файл сразу удаляется
+// и исчезает вместе с отображением. Страницы вытесняются в файл, а не в
+// swap, так что массив и буфер могут быть больше оперативной памяти.
+static int *MapScratch(const char *path, size_t bytes) {
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd == -1) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    unlink(path);
+    if (ftruncate(fd, bytes) == -1) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+    void *map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "%s: mmap failed: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    return (int *)map;
+}
+
+static bool IsSorted(const int *array, size_t size) {
+    for (size_t i = 1; i < size; i++) {
+        if (array[i - 1] > array[i]) return false;
+    }
+    return true;
+}
+
+// Параллельная сортировка массива int: LSD radix (разряды по ширине
+// max - min из прохода min/max), sample sort или слияние; в памяти, на
+// месте в файле (--input --in_place) или вне памяти (--scratch)
+int main(int argc, char **argv) {
+    int threads_num = 0;
+    size_t array_size = 0;
+    int seed = -1;
+    enum SortAlgorithm algorithm = SORT_RADIX;
+    const char *input = NULL;
+    bool in_place = false;
+    const char *output = NULL;
+    const char *scratch = NULL;
+    int dataset_flags = 0;
+    bool compare_qsort = false;
+    enum TimingFormat timing = TIMING_NONE;
+
+    static struct option options[] = {
+        {"threads_num", required_argument, 0, 0},
+        {"array_size", required_argument, 0, 0},
+        {"seed", required_argument, 0, 0},
+        {"algorithm", required_argument, 0, 0},
+        {"input", required_argument, 0, 0},
+        {"in_place", no_argument, 0, 0},
+        {"output", required_argument, 0, 0},
+        {"scratch", required_argument, 0, 0},
+        {"populate", no_argument, 0, 0},
+        {"compare_qsort", no_argument, 0, 0},
+        {"timing", required_argument, 0, 0},
+        {0, 0, 0, 0}
+    };
+
+    int option_index = 0;
+    while (true) {
+        int c = getopt_long(argc, argv, "", options, &option_index);
+        if (c == -1) break;
+
+        switch (c) {
+            case 0:
+                switch (option_index) {
+                    case 0:
+                        threads_num = atoi(optarg);
+                        if (threads_num <= 0) {
+                            printf("Threads number must be a positive number\n");
+                            return 1;
+                        }
+                        break;
+                    case 1:
+                        if (atoll(optarg) <= 0) {
+                            printf("Array size must be a positive number\n");
+                            return 1;
+                        }
+                        array_size = (size_t)atoll(optarg);
+                        break;
+                    case 2:
+                        seed = atoi(optarg);
+                        if (seed <= 0) {
+                            printf("Seed must be a positive number\n");
+                            return 1;
+                        }
+                        break;
+                    case 3:
+                        if (strcmp(optarg, "radix") == 0) {
+                            algorithm = SORT_RADIX;
+                        } else if (strcmp(optarg, "sample") == 0) {
+                            algorithm = SORT_SAMPLE;
+                        } else if (strcmp(optarg, "merge") == 0) {
+                            algorithm = SORT_MERGE;
+                        } else {
+                            printf("Algorithm must be radix, sample or merge\n");
+                            return 1;
+                        }
+                        break;
+                    case 4:
+                        input = optarg;
+                        break;
+                    case 5:
+                        in_place = true;
+                        break;
+                    case 6:
+                        output = optarg;
+                        break;
+                    case 7:
+                        scratch = optarg;
+                        break;
+                    case 8:
+                        dataset_flags |= DATASET_POPULATE;
+                        break;
+                    case 9:
+                        compare_qsort = true;
+                        break;
+                    case 10:
+                        if (ParseTimingFormat(optarg, &timing) == -1) {
+                            printf("Timing format must be none, text or json\n");
+                            return 1;
+                        }
+                        break;
+                }
+                break;
+            case '?':
+                break;
+            default:
+                printf("getopt returned character code 0%o?\n", c);
+        }
+    }
+
+    if (threads_num == 0 || (input == NULL && (seed == -1 || array_size == 0)) ||
+        (in_place && input == NULL)) {
+        printf("Usage: %s --threads_num \"num\" {--seed \"num\" --array_size \"num\" | --input \"file\" [--in_place] [--populate]} [--algorithm radix|sample|merge] [--output \"file\"] [--scratch \"file\"] [--compare_qsort] [--timing text|json]\n",
+               argv[0]);
+        return 1;
+    }
+
+    // Массив: сгенерированный, копия файла или сам файл (--in_place)
+    struct Dataset dataset = {0};
+    int *array = NULL;
+    if (input != NULL) {
+        if (in_place) dataset_flags |= DATASET_WRITABLE;
+        if (OpenDataset(input, dataset_flags, &dataset) == -1) return 1;
+        if (dataset.type != ELEMENT_INT32 || dataset.count == 0) {
+            printf("Input must hold int32 elements\n");
+            return 1;
+        }
+        array_size = dataset.count;
+    }
+    size_t bytes = sizeof(int) * array_size;
+    if (in_place) {
+        array = (int *)dataset.data;
+    } else {
+        array = AllocateLarge(bytes, false, NULL);
+        if (array == NULL) {
+            perror("mmap failed");
+            return 1;
+        }
+        if (input != NULL) {
+            memcpy(array, dataset.data, bytes);
+            CloseDataset(&dataset);
+        } else {
+            GenerateArray(array, array_size, seed);
+        }
+    }
+
+    int *buffer = scratch ? MapScratch(scratch, bytes)
+                          : AllocateLarge(bytes, false, NULL);
+    if (buffer == NULL) {
+        if (scratch == NULL) perror("mmap failed");
+        return 1;
+    }
+    int *reference = NULL;
+    if (compare_qsort) {
+        reference = malloc(bytes);
+        if (reference == NULL) {
+            perror("malloc failed");
+            return 1;
+        }
+        memcpy(reference, array, bytes);
+    }
+
+    struct Timeline timeline;
+    InitTimeline(&timeline);
+    struct MinMax range = {0, 0};
+    int radix_passes = 0;
+    if (algorithm == SORT_RADIX) {
+        // min и max тем же движком свертки, что и в parallel_reduce
+        struct ReduceConfig config = {REDUCE_THREADS, threads_num, NULL, false,
+                                      NULL};
+        struct ReduceOp op = {&min_max_reducer, NULL};
+        struct ReduceResult result;
+        int span = BeginSpan(&timeline, "min_max", SPAN_NO_WORKER);
+        if (RunReduction(&config, array, array_size, &op, 1, &result) == -1) {
+            return 1;
+        }
+        EndSpan(&timeline, span);
+        range = *(struct MinMax *)result.states[0];
+        FreeReduceResult(&result);
+    }
+
+    int sort_span = BeginSpan(&timeline, "sort", SPAN_NO_WORKER);
+    switch (algorithm) {
+        case SORT_RADIX:
+            radix_passes = RadixSort(array, buffer, array_size, range, threads_num);
+            break;
+        case SORT_SAMPLE:
+            SampleSort(array, buffer, array_size, sizeof(int), CompareInts,
+                       threads_num);
+            break;
+        case SORT_MERGE:
+            MergeSort(array, buffer, array_size, threads_num);
+            break;
+    }
+    EndSpan(&timeline, sort_span);
+    double elapsed_time = (MonotonicNs() - timeline.origin_ns) / 1e6;
+
+    bool sorted = IsSorted(array, array_size);
+    printf("Algorithm: %s\n", AlgorithmName(algorithm));
+    if (algorithm == SORT_RADIX) {
+        printf("Radix passes: %d, range [%d, %d]\n", radix_passes, range.min,
+               range.max);
+    }
+    printf("Sorted: %s\n", sorted ? "yes" : "no");
+    printf("Elapsed time: %f ms\n", elapsed_time);
+    PrintTimeline(&timeline, timing, stdout);
+    FreeTimeline(&timeline);
+
+    // Эталон: однопоточный qsort того же массива
+    bool matches = true;
+    if (compare_qsort) {
+        uint64_t start_ns = MonotonicNs();
+        qsort(reference, array_size, sizeof(int), CompareInts);
+        double qsort_time = (MonotonicNs() - start_ns) / 1e6;
+        matches = memcmp(reference, array, bytes) == 0;
+        printf("qsort time: %f ms\n", qsort_time);
+        printf("Speedup vs qsort: %.2fx\n", qsort_time / elapsed_time);
+        printf("Matches qsort: %s\n", matches ? "yes" : "no");
+        free(reference);
+    }
+
+    int status = sorted && matches ? 0 : 1;
+    // Сводки зон в файле описывают несортированный порядок: после
+    // сортировки на месте пересчитываем их прямо в отображении
+    if (in_place && dataset.zones != NULL) {
+        struct ZoneMap zones;
+        if (BuildZoneMap(&zones, array, array_size, dataset.zone_size,
+                         threads_num) == -1) {
+            printf("Failed to rebuild zone map\n");
+            status = 1;
+        } else {
+            memcpy((struct ZoneSummary *)dataset.zones, zones.zones,
+                   zones.zone_count * sizeof(struct ZoneSummary));
+            printf("Zone map: %u zones rebuilt\n", zones.zone_count);
+            FreeZoneMap(&zones);
+        }
+    }
+    if (output != NULL &&
+        WriteDataset(output, array, array_size, 0, NULL, 0, 0) == -1) {
+        status = 1;
+    }
+
+    if (scratch) munmap(buffer, bytes);
+    else FreeLarge(buffer, bytes);
+    if (in_place) CloseDataset(&dataset);
+    else FreeLarge(array, bytes);
+    return status;
+}
@@ -1,25 +1,43 @@
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <getopt.h>
-#include <sys/time.h>
 
-#include <pthread.h>
-
-#include "sum_lib.h"
+#include "dataset.h"
+#include "perf_counters.h"
+#include "reduce.h"
+#include "reducers.h"
+#include "timing.h"
+#include "topology.h"
 #include "utils.h"
 
 int main(int argc, char **argv) {
     uint32_t threads_num = 0;
-    uint32_t array_size = 0;
+    size_t array_size = 0;
     uint32_t seed = 0;
+    const char *input = NULL;
+    int dataset_flags = 0;
+    enum PinPolicy pin_policy = PIN_NONE;
+    bool numa = false;
+    bool hugetlb = false;
+    bool perf = false;
+    enum TimingFormat timing = TIMING_NONE;
     
     // Парсинг аргументов командной строки
     static struct option options[] = {
         {"threads_num", required_argument, 0, 0},
         {"array_size", required_argument, 0, 0},
         {"seed", required_argument, 0, 0},
+        {"input", required_argument, 0, 0},
+        {"populate", no_argument, 0, 0},
+        {"sequential", no_argument, 0, 0},
+        {"pin", required_argument, 0, 0},
+        {"numa", no_argument, 0, 0},
+        {"hugetlb", no_argument, 0, 0},
+        {"perf", no_argument, 0, 0},
+        {"timing", required_argument, 0, 0},
         {0, 0, 0, 0}
     };
 
@@ -39,15 +57,45 @@ int main(int argc, char **argv) {
                         }
                         break;
                     case 1:
-                        array_size = atoi(optarg);
-                        if (array_size <= 0) {
+                        if (atoll(optarg) <= 0) {
                             printf("Array size must be positive\n");
                             return 1;
                         }
+                        array_size = (size_t)atoll(optarg);
                         break;
                     case 2:
                         seed = atoi(optarg);
                         break;
+                    case 3:
+                        input = optarg;
+                        break;
+                    case 4:
+                        dataset_flags |= DATASET_POPULATE;
+                        break;
+                    case 5:
+                        dataset_flags |= DATASET_SEQUENTIAL;
+                        break;
+                    case 6:
+                        if (ParsePinPolicy(optarg, &pin_policy) == -1) {
+                            printf("Pin policy must be none, compact, scatter or smt-avoid\n");
+                            return 1;
+                        }
+                        break;
+                    case 7:
+                        numa = true;
+                        break;
+                    case 8:
+                        hugetlb = true;
+                        break;
+                    case 9:
+                        perf = true;
+                        break;
+                    case 10:
+                        if (ParseTimingFormat(optarg, &timing) == -1) {
+                            printf("Timing format must be none, text or json\n");
+                            return 1;
+                        }
+                        break;
                 }
                 break;
             case '?':
@@ -57,57 +105,109 @@ int main(int argc, char **argv) {
         }
     }
 
-    if (threads_num == 0 || array_size == 0) {
-        printf("Usage: %s --threads_num \"num\" --array_size \"num\" --seed \"num\"\n", argv[0]);
+    if (threads_num == 0 || (array_size == 0 && input == NULL)) {
+        printf("Usage: %s --threads_num \"num\" {--array_size \"num\" --seed \"num\" | --input \"file\" [--populate] [--sequential]} [--pin compact|scatter|smt-avoid] [--numa] [--hugetlb] [--perf] [--timing text|json]\n", argv[0]);
         return 1;
     }
 
-    // Генерация массива (не входит в замер времени)
-    int *array = malloc(sizeof(int) * array_size);
-    GenerateArray(array, array_size, seed);
-
-    // Подготовка аргументов для потоков
-    struct SumArgs args[threads_num];
-    int segment_size = array_size / threads_num;
-    for (uint32_t i = 0; i < threads_num; i++) {
-        args[i].array = array;
-        args[i].begin = i * segment_size;
-        args[i].end = (i == threads_num - 1) ? array_size : (i + 1) * segment_size;
+    // --numa без политики раскладывает потоки по узлам (scatter)
+    struct Topology topology = {0};
+    int *cpus = NULL;
+    if (numa && pin_policy == PIN_NONE) pin_policy = PIN_SCATTER;
+    if (pin_policy != PIN_NONE) {
+        if (LoadTopology(&topology) == -1) {
+            perror("sched_getaffinity failed");
+            return 1;
+        }
+        cpus = malloc(threads_num * sizeof(int));
+        PlanPlacement(&topology, pin_policy, threads_num, cpus);
     }
 
-    // Создание потоков и замер времени
-    struct timeval start_time, end_time;
-    gettimeofday(&start_time, NULL);
-
-    pthread_t threads[threads_num];
-    
-    // Создание потоков
-    for (uint32_t i = 0; i < threads_num; i++) {
-        if (pthread_create(&threads[i], NULL, ThreadSum, (void *)&args[i])) {
-            printf("Error: pthread_create failed!\n");
-            free(array);
+    // Генерация массива или отображение файла (не входит в замер времени)
+    struct Dataset dataset = {0};
+    int *array = NULL;
+    enum PageKind pages = PAGES_NORMAL;
+    if (input != NULL) {
+        if (OpenDataset(input, dataset_flags, &dataset) == -1) return 1;
+        if (dataset.type != ELEMENT_INT32 || dataset.count == 0) {
+            printf("Input must hold int32 elements\n");
             return 1;
         }
+        array = (int *)dataset.data;
+        array_size = dataset.count;
+    } else {
+        array = AllocateLarge(sizeof(int) * array_size, hugetlb, &pages);
+        if (array == NULL) {
+            perror("mmap failed");
+            return 1;
+        }
+        // С --numa сегмент каждого потока заполняется на его CPU (first touch)
+        if (numa) {
+            GeneratePlaced(&topology, cpus, threads_num, array, array_size, seed);
+        } else {
+            GenerateArray(array, array_size, seed);
+        }
     }
-
-    // Сбор результатов
-    int total_sum = 0;
-    for (uint32_t i = 0; i < threads_num; i++) {
-        int sum = 0;
-        pthread_join(threads[i], (void **)&sum);
-        total_sum += sum;
+    if (numa && input != NULL) {
+        printf("NUMA placement applies to generated arrays only\n");
     }
 
-    gettimeofday(&end_time, NULL);
+    // Сумма считается общим движком свертки на потоках
+    struct Timeline timeline;
+    InitTimeline(&timeline);
+    struct ReduceConfig config = {REDUCE_THREADS, (int)threads_num, cpus, perf,
+                                  &timeline};
+    struct ReduceOp op = {&sum_reducer, NULL};
+    struct ReduceResult result;
+    if (RunReduction(&config, array, array_size, &op, 1, &result) == -1) {
+        if (input != NULL) CloseDataset(&dataset);
+        else FreeLarge(array, sizeof(int) * array_size);
+        return 1;
+    }
 
     // Вычисление времени выполнения
-    double elapsed_time = (end_time.tv_sec - start_time.tv_sec) * 1000.0;
-    elapsed_time += (end_time.tv_usec - start_time.tv_usec) / 1000.0;
+    double elapsed_time = (MonotonicNs() - timeline.origin_ns) / 1e6;
+    int64_t total_sum = *(int64_t *)result.states[0];
 
     // Вывод результатов
-    printf("Total: %d\n", total_sum);
+    printf("Total: %lld\n", (long long)total_sum);
     printf("Elapsed time: %f ms\n", elapsed_time);
+    PrintTimeline(&timeline, timing, stdout);
+    FreeTimeline(&timeline);
+
+    if (cpus) {
+        unsigned long elements[threads_num];
+        double busy_ms[threads_num];
+        for (uint32_t i = 0; i < threads_num; i++) {
+            elements[i] = result.stats[i].elements;
+            busy_ms[i] =
+                (result.stats[i].finished_ns - result.stats[i].started_ns) / 1e6;
+            printf("Thread %u: cpu %d, node %d, %lu elements, %.3fms\n", i,
+                   cpus[i], NodeOfCpu(&topology, cpus[i]), elements[i],
+                   busy_ms[i]);
+        }
+        PrintNodeBandwidth(&topology, cpus, threads_num, elements, busy_ms,
+                           sizeof(int));
+        printf("Placement: %s%s\n", PinPolicyName(pin_policy),
+               numa && input == NULL ? ", NUMA first touch" : "");
+    }
+    if (perf) {
+        struct PerfValues total;
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) total.value[c] = -1;
+        char label[32];
+        for (uint32_t i = 0; i < threads_num; i++) {
+            snprintf(label, sizeof(label), "Perf thread %u", i);
+            PrintPerfValues(label, &result.stats[i].perf);
+            AddPerfValues(&total, &result.stats[i].perf);
+        }
+        PrintPerfValues("Perf total", &total);
+    }
+    if (input == NULL) printf("Pages: %s\n", PageKindName(pages));
 
-    free(array);
+    if (input != NULL) CloseDataset(&dataset);
+    else FreeLarge(array, sizeof(int) * array_size);
+    FreeReduceResult(&result);
+    free(cpus);
+    FreeTopology(&topology);
     return 0;
 }
\ No newline at end of file
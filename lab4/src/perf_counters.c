@@ -0,0 +1,127 @@
+#include "perf_counters.h"
+
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+struct PerfEventSpec {
+  uint32_t type;
+  uint64_t config;
+};
+
+static const struct PerfEventSpec perf_events[PERF_COUNTER_COUNT] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+};
+
+int StartPerfCounters(struct PerfCounters *counters) {
+  int opened = 0;
+  for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = perf_events[i].type;
+    attr.config = perf_events[i].config;
+    attr.disabled = 1;
+    // Без ядра, чтобы хватало perf_event_paranoid <= 2
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    // pid 0, cpu -1: только вызывающий поток, на любом CPU
+    counters->fd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (counters->fd[i] != -1) opened++;
+  }
+  for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+    if (counters->fd[i] != -1) ioctl(counters->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+  }
+  return opened;
+}
+
+void StopPerfCounters(struct PerfCounters *counters, struct PerfValues *values) {
+  for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+    if (counters->fd[i] != -1) ioctl(counters->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+  }
+  for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+    values->value[i] = -1;
+    if (counters->fd[i] == -1) continue;
+
+    // value, time_enabled, time_running: если счетчиков больше, чем PMU,
+    // ядро их чередует, и значение нужно масштабировать
+    uint64_t data[3];
+    if (read(counters->fd[i], data, sizeof(data)) == sizeof(data) &&
+        data[2] > 0) {
+      values->value[i] =
+          data[2] < data[1] ? (int64_t)((double)data[0] * data[1] / data[2])
+                            : (int64_t)data[0];
+    }
+    close(counters->fd[i]);
+    counters->fd[i] = -1;
+  }
+}
+
+struct PerfValues *CreatePerfSlots(int count) {
+  void *mem = mmap(NULL, sizeof(struct PerfValues) * count,
+                   PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED) return NULL;
+  struct PerfValues *slots = (struct PerfValues *)mem;
+  for (int w = 0; w < count; w++) {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) slots[w].value[i] = -1;
+  }
+  return slots;
+}
+
+void DestroyPerfSlots(struct PerfValues *slots, int count) {
+  munmap(slots, sizeof(struct PerfValues) * count);
+}
+
+void AddPerfValues(struct PerfValues *acc, const struct PerfValues *part) {
+  for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+    if (part->value[i] < 0) continue;
+    acc->value[i] = (acc->value[i] < 0 ? 0 : acc->value[i]) + part->value[i];
+  }
+}
+
+static void PrintCounter(const char *name, int64_t value) {
+  if (value < 0) {
+    printf(", %s n/a", name);
+  } else {
+    printf(", %s %lld", name, (long long)value);
+  }
+}
+
+void PrintPerfValues(const char *label, const struct PerfValues *values) {
+  const int64_t *v = values->value;
+  printf("%s: ", label);
+  if (v[PERF_CYCLES] < 0) {
+    printf("cycles n/a");
+  } else {
+    printf("cycles %lld", (long long)v[PERF_CYCLES]);
+  }
+  PrintCounter("instructions", v[PERF_INSTRUCTIONS]);
+  PrintCounter("LLC misses", v[PERF_LLC_MISSES]);
+  PrintCounter("branch misses", v[PERF_BRANCH_MISSES]);
+  PrintCounter("page faults", v[PERF_PAGE_FAULTS]);
+
+  // Низкий IPC при большом числе промахов LLC - упор в память,
+  // много промахов предсказания на тысячу инструкций - в ветвления
+  if (v[PERF_CYCLES] > 0 && v[PERF_INSTRUCTIONS] >= 0) {
+    printf(", IPC %.2f", (double)v[PERF_INSTRUCTIONS] / v[PERF_CYCLES]);
+  }
+  if (v[PERF_INSTRUCTIONS] > 0 && v[PERF_BRANCH_MISSES] >= 0) {
+    printf(", branch MPKI %.2f",
+           1000.0 * v[PERF_BRANCH_MISSES] / v[PERF_INSTRUCTIONS]);
+  }
+  if (v[PERF_INSTRUCTIONS] > 0 && v[PERF_LLC_MISSES] >= 0) {
+    printf(", LLC MPKI %.2f", 1000.0 * v[PERF_LLC_MISSES] / v[PERF_INSTRUCTIONS]);
+  }
+  printf("\n");
+}
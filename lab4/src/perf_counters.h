@@ -0,0 +1,42 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+
+// Аппаратные и программные счетчики одного воркера через perf_event_open
+enum PerfCounter {
+  PERF_CYCLES,
+  PERF_INSTRUCTIONS,
+  PERF_LLC_MISSES,
+  PERF_BRANCH_MISSES,
+  PERF_PAGE_FAULTS,
+  PERF_COUNTER_COUNT
+};
+
+// Значение -1 - счетчик недоступен (нет PMU в виртуалке, запрещен
+// perf_event_paranoid и т.п.); остальные счетчики при этом работают
+struct PerfValues {
+  int64_t value[PERF_COUNTER_COUNT];
+};
+
+struct PerfCounters {
+  int fd[PERF_COUNTER_COUNT];
+};
+
+// Открывает и запускает счетчики вызывающего потока (только user space);
+// возвращает число открытых счетчиков
+int StartPerfCounters(struct PerfCounters *counters);
+// Останавливает, читает (с поправкой на мультиплексирование) и закрывает
+void StopPerfCounters(struct PerfCounters *counters, struct PerfValues *values);
+
+// Анонимное MAP_SHARED отображение под результаты count воркеров,
+// видимое после fork(); изначально все счетчики недоступны
+struct PerfValues *CreatePerfSlots(int count);
+void DestroyPerfSlots(struct PerfValues *slots, int count);
+
+// acc += part по доступным счетчикам
+void AddPerfValues(struct PerfValues *acc, const struct PerfValues *part);
+// Строка "label: cycles ..., IPC ..." со счетчиками и производными метриками
+void PrintPerfValues(const char *label, const struct PerfValues *values);
+
+#endif
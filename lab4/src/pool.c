@@ -0,0 +1,294 @@
+#include "pool.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#include "find_min_max.h"
+#include "worker_slots.h"
+
+// Емкость кольца; запрос делится не более чем на POOL_RING_SIZE задач
+#define POOL_RING_SIZE 1024
+// Запрос короче этого числа элементов не дробится между воркерами
+#define POOL_MIN_TASK (1u << 16)
+// Сколько раз проверить очередь перед засыпанием на futex
+#define POOL_SPIN 2000
+// Как часто ждущий ответа родитель проверяет, что воркеры живы
+#define POOL_WAIT_MS 100
+
+enum TaskKind { TASK_SCAN, TASK_STOP };
+
+struct PoolTask {
+  int kind;
+  unsigned int dataset;
+  unsigned int begin;
+  unsigned int end;
+};
+
+// Результат текущего запроса: воркеры сливают в него свои min/max
+struct PoolResult {
+  atomic_int min;
+  atomic_int max;
+  atomic_uint remaining;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+struct PoolRing {
+  atomic_uint head __attribute__((aligned(CACHE_LINE_SIZE)));
+  atomic_uint tail __attribute__((aligned(CACHE_LINE_SIZE)));
+  atomic_uint sleepers;
+  struct PoolResult result;
+  struct PoolTask tasks[POOL_RING_SIZE];
+};
+
+struct WorkerPool {
+  struct PoolRing *ring;
+  const struct PoolDataset *datasets;
+  int dataset_count;
+  int workers;
+  pid_t *pids;
+  // Какой-то воркер завершился: его задачи потеряны, пул больше не отвечает
+  bool dead;
+};
+
+// timeout == NULL - ждать без ограничения
+static void FutexWait(atomic_uint *addr, unsigned int expected,
+                      const struct timespec *timeout) {
+  // Без FUTEX_PRIVATE_FLAG: слово лежит в общей памяти разных процессов
+  syscall(SYS_futex, addr, FUTEX_WAIT, expected, timeout, NULL, 0);
+}
+
+static void FutexWake(atomic_uint *addr) {
+  syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+static void AtomicMin(atomic_int *target, int value) {
+  int current = atomic_load_explicit(target, memory_order_relaxed);
+  while (value < current &&
+         !atomic_compare_exchange_weak(target, &current, value)) {
+  }
+}
+
+static void AtomicMax(atomic_int *target, int value) {
+  int current = atomic_load_explicit(target, memory_order_relaxed);
+  while (value > current &&
+         !atomic_compare_exchange_weak(target, &current, value)) {
+  }
+}
+
+static void PushTask(struct PoolRing *ring, struct PoolTask task) {
+  unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  ring->tasks[tail % POOL_RING_SIZE] = task;
+  atomic_store(&ring->tail, tail + 1);
+  if (atomic_load(&ring->sleepers) > 0) FutexWake(&ring->tail);
+}
+
+static struct PoolTask PopTask(struct PoolRing *ring) {
+  int spins = 0;
+  while (true) {
+    unsigned int head = atomic_load(&ring->head);
+    unsigned int tail = atomic_load(&ring->tail);
+    if (head == tail) {
+      if (++spins < POOL_SPIN) continue;
+      atomic_fetch_add(&ring->sleepers, 1);
+      FutexWait(&ring->tail, tail, NULL);
+      atomic_fetch_sub(&ring->sleepers, 1);
+      spins = 0;
+      continue;
+    }
+
+    // Копируем задачу до захвата: если CAS не удался, копия просто отбросится
+    struct PoolTask task = ring->tasks[head % POOL_RING_SIZE];
+    if (atomic_compare_exchange_weak(&ring->head, &head, head + 1)) {
+      return task;
+    }
+  }
+}
+
+static void WorkerLoop(struct PoolRing *ring,
+                       const struct PoolDataset *datasets) {
+  while (true) {
+    struct PoolTask task = PopTask(ring);
+    if (task.kind == TASK_STOP) return;
+
+    struct MinMax local =
+        GetMinMax(datasets[task.dataset].array, task.begin, task.end);
+    AtomicMin(&ring->result.min, local.min);
+    AtomicMax(&ring->result.max, local.max);
+    if (atomic_fetch_sub(&ring->result.remaining, 1) == 1) {
+      FutexWake(&ring->result.remaining);
+    }
+  }
+}
+
+struct WorkerPool *CreateWorkerPool(int workers,
+                                    const struct PoolDataset *datasets,
+                                    int dataset_count) {
+  if (workers <= 0 || workers > POOL_RING_SIZE) return NULL;
+
+  void *mem = mmap(NULL, sizeof(struct PoolRing), PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED) return NULL;
+
+  struct WorkerPool *pool = malloc(sizeof(struct WorkerPool));
+  pool->ring = (struct PoolRing *)mem;
+  pool->datasets = datasets;
+  pool->dataset_count = dataset_count;
+  pool->workers = 0;
+  pool->dead = false;
+  pool->pids = malloc(workers * sizeof(pid_t));
+
+  fflush(NULL);
+  for (int i = 0; i < workers; i++) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      // Воркер не должен пережить родителя, который раздает ему задачи
+      prctl(PR_SET_PDEATHSIG, SIGKILL);
+      if (getppid() == 1) _exit(1);
+      WorkerLoop(pool->ring, datasets);
+      _exit(0);
+    }
+    if (pid < 0) {
+      perror("fork failed");
+      DestroyWorkerPool(pool);
+      return NULL;
+    }
+    pool->pids[pool->workers++] = pid;
+  }
+  return pool;
+}
+
+// Собирает завершившихся воркеров; true, если такие были
+static bool ReapExitedWorkers(struct WorkerPool *pool) {
+  for (int i = 0; i < pool->workers; i++) {
+    if (pool->pids[i] <= 0) continue;
+    int status;
+    if (waitpid(pool->pids[i], &status, WNOHANG) != pool->pids[i]) continue;
+    if (WIFSIGNALED(status)) {
+      fprintf(stderr, "Pool worker %d killed by signal %d\n", pool->pids[i],
+              WTERMSIG(status));
+    } else {
+      fprintf(stderr, "Pool worker %d exited with status %d\n", pool->pids[i],
+              WEXITSTATUS(status));
+    }
+    pool->pids[i] = -1;
+    pool->dead = true;
+  }
+  return pool->dead;
+}
+
+bool PoolAlive(struct WorkerPool *pool) { return !ReapExitedWorkers(pool); }
+
+int PoolQuery(struct WorkerPool *pool, unsigned int dataset,
+              unsigned int offset, unsigned int length, struct MinMax *result) {
+  if (pool->dead) return -1;
+  if (dataset >= (unsigned int)pool->dataset_count) return -1;
+  unsigned int size = pool->datasets[dataset].size;
+  if (offset > size || length > size - offset) return -1;
+
+  if (length == 0) {
+    result->min = INT_MAX;
+    result->max = INT_MIN;
+    return 0;
+  }
+
+  unsigned int tasks = length / POOL_MIN_TASK + 1;
+  if (tasks > (unsigned int)pool->workers) tasks = pool->workers;
+  unsigned int segment = length / tasks;
+
+  struct PoolRing *ring = pool->ring;
+  atomic_store(&ring->result.min, INT_MAX);
+  atomic_store(&ring->result.max, INT_MIN);
+  atomic_store(&ring->result.remaining, tasks);
+
+  for (unsigned int t = 0; t < tasks; t++) {
+    struct PoolTask task;
+    task.kind = TASK_SCAN;
+    task.dataset = dataset;
+    task.begin = offset + t * segment;
+    task.end = (t == tasks - 1) ? offset + length : task.begin + segment;
+    PushTask(ring, task);
+  }
+
+  // Ждем с таймаутом: умерший воркер никогда не уменьшит remaining, так
+  // что после каждого пробуждения проверяем, что все воркеры живы
+  const struct timespec timeout = {0, POOL_WAIT_MS * 1000000L};
+  int spins = 0;
+  unsigned int remaining;
+  while ((remaining = atomic_load(&ring->result.remaining)) != 0) {
+    if (++spins < POOL_SPIN) continue;
+    if (spins > POOL_SPIN && ReapExitedWorkers(pool)) return -1;
+    FutexWait(&ring->result.remaining, remaining, &timeout);
+  }
+
+  result->min = atomic_load(&ring->result.min);
+  result->max = atomic_load(&ring->result.max);
+  return 0;
+}
+
+long ServeQueries(struct WorkerPool *pool, FILE *in, FILE *out,
+                  double *total_latency_us) {
+  char line[256];
+  long served = 0;
+  while (fgets(line, sizeof(line), in) != NULL) {
+    unsigned int offset, length, dataset = 0;
+    int fields = sscanf(line, "%u %u %u", &offset, &length, &dataset);
+    if (fields < 2) {
+      if (fields != EOF) fprintf(out, "error: expected offset length [dataset]\n");
+      fflush(out);
+      continue;
+    }
+
+    struct timespec start, finish;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    struct MinMax result;
+    int rc = PoolQuery(pool, dataset, offset, length, &result);
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+
+    if (rc == 0) {
+      fprintf(out, "%d %d\n", result.min, result.max);
+      served++;
+      *total_latency_us += (finish.tv_sec - start.tv_sec) * 1e6 +
+                           (finish.tv_nsec - start.tv_nsec) / 1e3;
+    } else if (pool->dead) {
+      fprintf(out, "error: pool worker exited\n");
+      fflush(out);
+      break;
+    } else {
+      fprintf(out, "error: range out of bounds\n");
+    }
+    fflush(out);
+  }
+  return served;
+}
+
+void DestroyWorkerPool(struct WorkerPool *pool) {
+  ReapExitedWorkers(pool);
+  if (pool->dead) {
+    // В кольце могли остаться задачи умершего воркера: оставшихся не
+    // дожидаемся, а убиваем
+    for (int i = 0; i < pool->workers; i++) {
+      if (pool->pids[i] > 0) kill(pool->pids[i], SIGKILL);
+    }
+  } else {
+    struct PoolTask stop = {TASK_STOP, 0, 0, 0};
+    for (int i = 0; i < pool->workers; i++) PushTask(pool->ring, stop);
+  }
+  for (int i = 0; i < pool->workers; i++) {
+    if (pool->pids[i] > 0) waitpid(pool->pids[i], NULL, 0);
+  }
+
+  munmap(pool->ring, sizeof(struct PoolRing));
+  free(pool->pids);
+  free(pool);
+}
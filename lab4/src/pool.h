@@ -0,0 +1,41 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "utils.h"
+
+// Набор данных, доступный воркерам пула (наследуется ими через fork())
+struct PoolDataset {
+  int *array;
+  unsigned int size;
+};
+
+struct WorkerPool;
+
+// Запускает workers долгоживущих процессов. Задачи передаются им через
+// кольцевой буфер в общей памяти, ожидание - через futex, так что запрос
+// не требует ни fork(), ни создания пайпов.
+struct WorkerPool *CreateWorkerPool(int workers,
+                                    const struct PoolDataset *datasets,
+                                    int dataset_count);
+
+// min/max по [offset, offset + length) набора dataset; 0 или -1. -1 и при
+// гибели воркера: после этого пул не отвечает на запросы (PoolAlive)
+int PoolQuery(struct WorkerPool *pool, unsigned int dataset,
+              unsigned int offset, unsigned int length, struct MinMax *result);
+
+// false, если какой-то воркер завершился
+bool PoolAlive(struct WorkerPool *pool);
+
+// Читает запросы "offset length [dataset]" построчно из in, отвечает
+// "min max" в out. Возвращает число обработанных запросов; прекращает
+// чтение, если воркер завершился.
+long ServeQueries(struct WorkerPool *pool, FILE *in, FILE *out,
+                  double *total_latency_us);
+
+// Останавливает воркеров и дожидается их завершения
+void DestroyWorkerPool(struct WorkerPool *pool);
+
+#endif
@@ -0,0 +1,298 @@
+#include "quantiles.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+// Поразрядная сортировка буфера: 4 прохода по байту со счетчиками,
+// собранными за один проход, быстрее qsort с компаратором
+static void SortBuffer(int *items, unsigned int n) {
+  unsigned int keys[SKETCH_BUFFER], scratch[SKETCH_BUFFER];
+  unsigned int counts[4][257];
+  memset(counts, 0, sizeof(counts));
+  for (unsigned int i = 0; i < n; i++) {
+    unsigned int key = (unsigned int)items[i] ^ 0x80000000u;
+    keys[i] = key;
+    for (int pass = 0; pass < 4; pass++) {
+      counts[pass][((key >> (8 * pass)) & 0xff) + 1]++;
+    }
+  }
+
+  unsigned int *from = keys, *to = scratch;
+  for (int pass = 0; pass < 4; pass++) {
+    for (int b = 0; b < 256; b++) counts[pass][b + 1] += counts[pass][b];
+    for (unsigned int i = 0; i < n; i++) {
+      to[counts[pass][(from[i] >> (8 * pass)) & 0xff]++] = from[i];
+    }
+    unsigned int *swap = from;
+    from = to;
+    to = swap;
+  }
+  for (unsigned int i = 0; i < n; i++) items[i] = (int)(from[i] ^ 0x80000000u);
+}
+
+static unsigned int NextBit(struct QuantileSketch *sketch) {
+  // xorshift64: достаточно для выбора четных или нечетных позиций
+  sketch->rng ^= sketch->rng << 13;
+  sketch->rng ^= sketch->rng >> 7;
+  sketch->rng ^= sketch->rng << 17;
+  return sketch->rng & 1;
+}
+
+static void AddSorted(struct QuantileSketch *sketch, int level,
+                      const int *batch, unsigned int n);
+
+// Сжимает отсортированный уровень: из каждой пары соседей один элемент с
+// удвоенным весом уходит выше, при нечетном размере последний остается
+static void Compact(struct QuantileSketch *sketch, int level) {
+  unsigned int n = sketch->size[level];
+  int *items = sketch->items[level];
+  unsigned int offset = NextBit(sketch);
+
+  // До верхнего уровня нужно больше 2^47 элементов; если все же дошли,
+  // он просто прореживается на месте
+  if (level == SKETCH_LEVELS - 1) {
+    for (unsigned int i = 0; i < n / 2; i++) items[i] = items[2 * i + offset];
+    sketch->size[level] = n / 2;
+    return;
+  }
+
+  int promoted[SKETCH_BUFFER];
+  for (unsigned int i = 0; i < n / 2; i++) promoted[i] = items[2 * i + offset];
+  if (n % 2) items[0] = items[n - 1];
+  sketch->size[level] = n % 2;
+  AddSorted(sketch, level + 1, promoted, n / 2);
+}
+
+// Вливает отсортированную пачку (не больше SKETCH_BUFFER) в уровень
+static void AddSorted(struct QuantileSketch *sketch, int level,
+                      const int *batch, unsigned int n) {
+  if (sketch->size[level] + n > SKETCH_CAPACITY) Compact(sketch, level);
+
+  // Слияние с конца без ветвлений: исход сравнений случаен и плохо
+  // предсказывается
+  int *items = sketch->items[level];
+  unsigned int i = sketch->size[level], j = n, k = i + n;
+  while (j > 0 && i > 0) {
+    int from_level = items[i - 1] > batch[j - 1];
+    items[--k] = from_level ? items[i - 1] : batch[j - 1];
+    i -= from_level;
+    j -= 1 - from_level;
+  }
+  while (j > 0) items[--k] = batch[--j];
+  sketch->size[level] += n;
+}
+
+// Сортирует накопленный буфер и вливает его в уровень выборки
+static void FlushBuffer(struct QuantileSketch *sketch) {
+  if (sketch->buffer_size == 0) return;
+  SortBuffer(sketch->buffer, sketch->buffer_size);
+  AddSorted(sketch, sketch->sample_level, sketch->buffer, sketch->buffer_size);
+  sketch->buffer_size = 0;
+}
+
+static void SketchAdd(struct QuantileSketch *sketch, int value) {
+  sketch->buffer[sketch->buffer_size++] = value;
+  if (sketch->buffer_size == SKETCH_BUFFER) FlushBuffer(sketch);
+}
+
+// Выбранный элемент группы добавлен; начинаем следующую группу, при
+// необходимости увеличив ее размер (буфер относится к старому уровню)
+static void NextSample(struct QuantileSketch *sketch, unsigned long count) {
+  if (sketch->sample_level + 1 < SKETCH_LEVELS &&
+      count >= SKETCH_SAMPLE_RATIO << (sketch->sample_level + 1)) {
+    FlushBuffer(sketch);
+    while (sketch->sample_level + 1 < SKETCH_LEVELS &&
+           count >= SKETCH_SAMPLE_RATIO << (sketch->sample_level + 1)) {
+      sketch->sample_level++;
+    }
+  }
+  NextBit(sketch);
+  unsigned long group = 1UL << sketch->sample_level;
+  unsigned long chosen = (sketch->rng >> 1) & (group - 1);
+  sketch->next_sample = sketch->group_tail + chosen + 1;
+  sketch->group_tail = group - 1 - chosen;
+}
+
+static void TopKAdd(struct TopK *top, int value) {
+  int *heap = top->items;
+  if (top->size < top->k) {
+    unsigned int i = top->size++;
+    while (i > 0 && heap[(i - 1) / 2] > value) {
+      heap[i] = heap[(i - 1) / 2];
+      i = (i - 1) / 2;
+    }
+    heap[i] = value;
+    return;
+  }
+  if (value <= heap[0]) return;
+
+  unsigned int i = 0;
+  while (true) {
+    unsigned int child = 2 * i + 1;
+    if (child >= top->size) break;
+    if (child + 1 < top->size && heap[child + 1] < heap[child]) child++;
+    if (heap[child] >= value) break;
+    heap[i] = heap[child];
+    i = child;
+  }
+  heap[i] = value;
+}
+
+void InitSummary(struct ValueSummary *summary, bool with_sketch,
+                 unsigned int top_k, uint64_t seed) {
+  memset(summary, 0, sizeof(*summary));
+  summary->with_sketch = with_sketch;
+  summary->sketch.rng = seed * 0x9e3779b97f4a7c15ULL + 1;
+  summary->sketch.next_sample = 1;
+  summary->top.k = top_k < MAX_TOP_K ? top_k : MAX_TOP_K;
+}
+
+static void SampleValue(struct ValueSummary *summary, int value) {
+  struct QuantileSketch *sketch = &summary->sketch;
+  if (--sketch->next_sample > 0) return;
+  SketchAdd(sketch, value);
+  NextSample(sketch, summary->count);
+}
+
+// Порог top-k: меньшие значения кучу не меняют
+static int TopKThreshold(const struct TopK *top) {
+  return top->size < top->k ? INT_MIN : top->items[0];
+}
+
+void AddToSummary(struct ValueSummary *summary, const int *array,
+                  size_t begin, size_t end, int lo, int hi, int block_max) {
+  bool with_top = summary->top.k > 0 &&
+                  block_max > TopKThreshold(&summary->top);
+
+  // С фильтром каждый элемент проверяется по отдельности
+  if (lo != INT_MIN || hi != INT_MAX) {
+    for (size_t i = begin; i < end; i++) {
+      int value = array[i];
+      if (value < lo || value > hi) continue;
+      summary->count++;
+      if (summary->with_sketch) SampleValue(summary, value);
+      if (with_top && value > TopKThreshold(&summary->top)) {
+        TopKAdd(&summary->top, value);
+      }
+    }
+    return;
+  }
+
+  // Без фильтра выборка перескакивает прямо к выбранным элементам, а top-k
+  // сравнивает с порогом в отдельном плотном цикле по тому же блоку
+  if (summary->with_sketch) {
+    struct QuantileSketch *sketch = &summary->sketch;
+    size_t i = begin;
+    while (end - i >= sketch->next_sample) {
+      i += sketch->next_sample;
+      summary->count += sketch->next_sample;
+      SketchAdd(sketch, array[i - 1]);
+      NextSample(sketch, summary->count);
+    }
+    sketch->next_sample -= end - i;
+    summary->count += end - i;
+  } else {
+    summary->count += end - begin;
+  }
+
+  if (with_top) {
+    int threshold = TopKThreshold(&summary->top);
+    for (size_t i = begin; i < end; i++) {
+      if (array[i] > threshold) {
+        TopKAdd(&summary->top, array[i]);
+        threshold = TopKThreshold(&summary->top);
+      }
+    }
+  }
+}
+
+void MergeSummary(struct ValueSummary *acc, const struct ValueSummary *part) {
+  acc->count += part->count;
+  if (acc->with_sketch) {
+    const struct QuantileSketch *sketch = &part->sketch;
+    for (int level = 0; level < SKETCH_LEVELS; level++) {
+      for (unsigned int i = 0; i < sketch->size[level]; i += SKETCH_BUFFER) {
+        unsigned int n = sketch->size[level] - i;
+        AddSorted(&acc->sketch, level, sketch->items[level] + i,
+                  n < SKETCH_BUFFER ? n : SKETCH_BUFFER);
+      }
+    }
+    int buffer[SKETCH_BUFFER];
+    memcpy(buffer, sketch->buffer, sketch->buffer_size * sizeof(int));
+    SortBuffer(buffer, sketch->buffer_size);
+    AddSorted(&acc->sketch, sketch->sample_level, buffer, sketch->buffer_size);
+  }
+  for (unsigned int i = 0; i < part->top.size; i++) {
+    TopKAdd(&acc->top, part->top.items[i]);
+  }
+}
+
+struct WeightedItem {
+  int value;
+  uint64_t weight;
+};
+
+static int CompareWeighted(const void *a, const void *b) {
+  int x = ((const struct WeightedItem *)a)->value;
+  int y = ((const struct WeightedItem *)b)->value;
+  return (x > y) - (x < y);
+}
+
+int SketchQuantile(const struct QuantileSketch *sketch, double q) {
+  size_t count = sketch->buffer_size;
+  for (int level = 0; level < SKETCH_LEVELS; level++) count += sketch->size[level];
+  struct WeightedItem *items = malloc(count * sizeof(struct WeightedItem));
+
+  size_t n = 0;
+  uint64_t total = 0;
+  for (unsigned int i = 0; i < sketch->buffer_size; i++) {
+    items[n].value = sketch->buffer[i];
+    items[n].weight = 1ULL << sketch->sample_level;
+    total += items[n++].weight;
+  }
+  for (int level = 0; level < SKETCH_LEVELS; level++) {
+    for (unsigned int i = 0; i < sketch->size[level]; i++) {
+      items[n].value = sketch->items[level][i];
+      items[n].weight = 1ULL << level;
+      total += items[n++].weight;
+    }
+  }
+  qsort(items, n, sizeof(struct WeightedItem), CompareWeighted);
+
+  double target = q * total;
+  uint64_t rank = 0;
+  int value = items[n - 1].value;
+  for (size_t i = 0; i < n; i++) {
+    rank += items[i].weight;
+    if (rank >= target) {
+      value = items[i].value;
+      break;
+    }
+  }
+  free(items);
+  return value;
+}
+
+static int CompareDescending(const void *a, const void *b) {
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x < y) - (x > y);
+}
+
+unsigned int SortedTopK(const struct TopK *top, int *out) {
+  memcpy(out, top->items, top->size * sizeof(int));
+  qsort(out, top->size, sizeof(int), CompareDescending);
+  return top->size;
+}
+
+struct ValueSummary *CreateSummarySlots(int count) {
+  void *mem = mmap(NULL, sizeof(struct ValueSummary) * count,
+                   PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED) return NULL;
+  return (struct ValueSummary *)mem;
+}
+
+void DestroySummarySlots(struct ValueSummary *slots, int count) {
+  munmap(slots, sizeof(struct ValueSummary) * count);
+}
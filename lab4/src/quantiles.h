@@ -0,0 +1,76 @@
+#ifndef QUANTILES_H
+#define QUANTILES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Приближенные квантили: KLL-подобный скетч из отсортированных уровней
+// одинаковой емкости. Элемент уровня l весит 2^l; при переполнении уровня
+// каждый второй его элемент (четные или нечетные позиции наугад) уходит
+// слиянием на уровень выше. Ошибка по рангу порядка
+// log2(n / SKETCH_CAPACITY) / SKETCH_CAPACITY.
+#define SKETCH_CAPACITY 1024
+#define SKETCH_LEVELS 40
+// Новые элементы копятся в неотсортированном буфере и сортируются пачкой
+#define SKETCH_BUFFER (SKETCH_CAPACITY / 2)
+// Как в KLL, нижние уровни заменяются выборкой: после SKETCH_SAMPLE_RATIO
+// << h элементов в скетч попадает один случайный из каждых 2^h подряд
+// (сразу с весом 2^h), так что сжатий почти нет. На 10^8 равномерных
+// значений максимальная ошибка по рангу около 0.2%.
+#define SKETCH_SAMPLE_RATIO (1UL << 15)
+
+// Точный top-k: min-куча из k наибольших значений
+#define MAX_TOP_K 1024
+
+struct QuantileSketch {
+  uint64_t rng;
+  // Выборка: уровень h, сколько элементов до выбранного и сколько после
+  // него до конца текущей группы из 2^h
+  unsigned int sample_level;
+  unsigned long next_sample;
+  unsigned long group_tail;
+  // Буфер выборки: элементы уровня sample_level в порядке поступления
+  unsigned int buffer_size;
+  int buffer[SKETCH_BUFFER];
+  unsigned int size[SKETCH_LEVELS];
+  int items[SKETCH_LEVELS][SKETCH_CAPACITY];
+};
+
+struct TopK {
+  unsigned int k;
+  unsigned int size;
+  int items[MAX_TOP_K];
+};
+
+// Сводка одного воркера целиком в одной структуре без указателей, чтобы
+// лежать в общей памяти и сливаться родителем после fork()
+struct ValueSummary {
+  // Сколько значений прошло фильтр
+  unsigned long count;
+  bool with_sketch;
+  struct QuantileSketch sketch;
+  struct TopK top;
+};
+
+// top_k == 0 - без top-k; seed задает случайный выбор при сжатии
+void InitSummary(struct ValueSummary *summary, bool with_sketch,
+                 unsigned int top_k, uint64_t seed);
+// Учитывает array[begin, end), только значения из [lo, hi]. block_max -
+// уже посчитанный максимум подходящих значений блока: если он не выше
+// порога top-k, блок для top-k не просматривается.
+void AddToSummary(struct ValueSummary *summary, const int *array,
+                  size_t begin, size_t end, int lo, int hi, int block_max);
+// acc += part; части должны быть созданы с одинаковыми параметрами
+void MergeSummary(struct ValueSummary *acc, const struct ValueSummary *part);
+
+// Значение с рангом около q * count, 0 <= q <= 1; скетч не должен быть пуст
+int SketchQuantile(const struct QuantileSketch *sketch, double q);
+// Наибольшие значения по убыванию в out; возвращает их число
+unsigned int SortedTopK(const struct TopK *top, int *out);
+
+// Анонимное MAP_SHARED отображение под сводки count воркеров
+struct ValueSummary *CreateSummarySlots(int count);
+void DestroySummarySlots(struct ValueSummary *slots, int count);
+
+#endif
@@ -0,0 +1,193 @@
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <getopt.h>
+
+#include "find_min_max.h"
+#include "range_index.h"
+#include "utils.h"
+
+// Набор запросов: диапазоны заданной максимальной длины и доля обновлений
+struct QueryMix {
+  const char *name;
+  unsigned int max_length;  // 0 - любая длина
+  int update_percent;
+};
+
+static const struct QueryMix mixes[] = {
+    {"short", 256, 0},
+    {"medium", 1u << 16, 0},
+    {"long", 0, 0},
+    {"long+10%upd", 0, 10},
+};
+
+static uint64_t rng_state;
+
+static uint64_t NextRandom(void) {
+  // xorshift64*: запросы детерминированы при одном и том же seed
+  rng_state ^= rng_state >> 12;
+  rng_state ^= rng_state << 25;
+  rng_state ^= rng_state >> 27;
+  return rng_state * 0x2545f4914f6cdd1dull;
+}
+
+static double NowUs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+struct Query {
+  bool update;
+  unsigned int begin;
+  unsigned int end;
+  int value;
+};
+
+static void MakeQueries(struct Query *queries, int count, unsigned int size,
+                        const struct QueryMix *mix) {
+  for (int i = 0; i < count; i++) {
+    struct Query *q = &queries[i];
+    q->update = (int)(NextRandom() % 100) < mix->update_percent;
+    q->begin = NextRandom() % size;
+    q->value = (int)(NextRandom() >> 33);
+    unsigned int limit = size - q->begin;
+    if (mix->max_length > 0 && mix->max_length < limit) limit = mix->max_length;
+    q->end = q->begin + 1 + NextRandom() % limit;
+  }
+}
+
+// Прогоняет запросы через один из способов; возвращает мкс на запрос и
+// контрольную сумму ответов для сверки
+enum Method { METHOD_SCAN, METHOD_SPARSE, METHOD_SEGMENT };
+
+static double RunQueries(enum Method method, int *array,
+                         struct SparseMinMax *sparse,
+                         struct SegmentMinMax *segment,
+                         const struct Query *queries, int count,
+                         int64_t *checksum) {
+  *checksum = 0;
+  double start = NowUs();
+  for (int i = 0; i < count; i++) {
+    const struct Query *q = &queries[i];
+    if (q->update) {
+      if (method == METHOD_SEGMENT) {
+        UpdateSegmentMinMax(segment, q->begin, q->value);
+      } else {
+        array[q->begin] = q->value;
+      }
+      continue;
+    }
+    struct MinMax r;
+    if (method == METHOD_SCAN) {
+      r = GetMinMax(array, q->begin, q->end);
+    } else if (method == METHOD_SPARSE) {
+      r = QuerySparseMinMax(sparse, q->begin, q->end);
+    } else {
+      r = QuerySegmentMinMax(segment, q->begin, q->end);
+    }
+    *checksum += (int64_t)r.min * 31 + r.max;
+  }
+  return (NowUs() - start) / count;
+}
+
+int main(int argc, char **argv) {
+  int seed = -1;
+  int array_size = -1;
+  int queries_num = 100000;
+  int threads_num = 0;
+
+  static struct option options[] = {{"seed", required_argument, 0, 0},
+                                    {"array_size", required_argument, 0, 0},
+                                    {"queries", required_argument, 0, 0},
+                                    {"threads_num", required_argument, 0, 0},
+                                    {0, 0, 0, 0}};
+
+  while (true) {
+    int option_index = 0;
+    int c = getopt_long(argc, argv, "", options, &option_index);
+    if (c == -1) break;
+    if (c != 0) continue;
+
+    int value = atoi(optarg);
+    if (value <= 0) {
+      printf("%s must be a positive number\n", options[option_index].name);
+      return 1;
+    }
+    switch (option_index) {
+      case 0: seed = value; break;
+      case 1: array_size = value; break;
+      case 2: queries_num = value; break;
+      case 3: threads_num = value; break;
+    }
+  }
+
+  if (seed == -1 || array_size == -1) {
+    printf("Usage: %s --seed \"num\" --array_size \"num\" [--queries \"num\"] [--threads_num \"num\"]\n",
+           argv[0]);
+    return 1;
+  }
+
+  int *array = malloc(sizeof(int) * array_size);
+  int *copy = malloc(sizeof(int) * array_size);
+  struct Query *queries = malloc(sizeof(struct Query) * queries_num);
+  GenerateArray(array, array_size, seed);
+  rng_state = 0x9e3779b97f4a7c15ull ^ (uint64_t)seed;
+
+  double start = NowUs();
+  struct SparseMinMax *sparse = BuildSparseMinMax(array, array_size, threads_num);
+  double sparse_build = NowUs() - start;
+
+  printf("Kernel: %s\n", GetMinMaxKernelName());
+  printf("Sparse table build: %fms\n", sparse_build / 1000);
+  printf("%-12s %14s %14s %14s\n", "mix", "scan us/q", "sparse us/q",
+         "segment us/q");
+
+  bool ok = true;
+  for (size_t m = 0; m < sizeof(mixes) / sizeof(mixes[0]); m++) {
+    MakeQueries(queries, queries_num, array_size, &mixes[m]);
+    int64_t scan_sum, sparse_sum = 0, segment_sum;
+
+    // Обновления меняют массив, поэтому каждый способ работает со своей копией
+    for (int i = 0; i < array_size; i++) copy[i] = array[i];
+    double scan = RunQueries(METHOD_SCAN, copy, NULL, NULL, queries,
+                             queries_num, &scan_sum);
+
+    double sparse_us = -1;
+    if (mixes[m].update_percent == 0) {
+      sparse_us = RunQueries(METHOD_SPARSE, array, sparse, NULL, queries,
+                             queries_num, &sparse_sum);
+    } else {
+      sparse_sum = scan_sum;  // разреженная таблица не поддерживает обновления
+    }
+
+    for (int i = 0; i < array_size; i++) copy[i] = array[i];
+    struct SegmentMinMax *segment =
+        BuildSegmentMinMax(copy, array_size, threads_num);
+    double segment_us = RunQueries(METHOD_SEGMENT, copy, NULL, segment,
+                                   queries, queries_num, &segment_sum);
+    FreeSegmentMinMax(segment);
+
+    if (sparse_us < 0) {
+      printf("%-12s %14.3f %14s %14.3f\n", mixes[m].name, scan, "-",
+             segment_us);
+    } else {
+      printf("%-12s %14.3f %14.3f %14.3f\n", mixes[m].name, scan, sparse_us,
+             segment_us);
+    }
+    if (scan_sum != sparse_sum || scan_sum != segment_sum) {
+      printf("Mismatch in mix %s!\n", mixes[m].name);
+      ok = false;
+    }
+  }
+
+  FreeSparseMinMax(sparse);
+  free(queries);
+  free(copy);
+  free(array);
+  return ok ? 0 : 1;
+}
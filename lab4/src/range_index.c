@@ -0,0 +1,183 @@
+#include "range_index.h"
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "find_min_max.h"
+
+struct SparseMinMax {
+  int *array;
+  unsigned int size;
+  unsigned int blocks;
+  unsigned int levels;
+  // levels[k][i] - min/max по блокам [i, i + 2^k)
+  struct MinMax **table;
+};
+
+struct SegmentMinMax {
+  int *array;
+  unsigned int size;
+  unsigned int blocks;
+  // Дерево снизу вверх: листья в nodes[blocks + i], корень в nodes[1]
+  struct MinMax *nodes;
+};
+
+static struct MinMax Merge(struct MinMax a, struct MinMax b) {
+  if (b.min < a.min) a.min = b.min;
+  if (b.max > a.max) a.max = b.max;
+  return a;
+}
+
+static unsigned int FloorLog2(unsigned int x) {
+  return 31 - __builtin_clz(x);
+}
+
+// Уровни меньше этого числа элементов не стоят создания потоков
+#define INDEX_BUILD_GRAIN 4096
+
+static struct MinMax BlockSummary(int *array, unsigned int size,
+                                  unsigned int block) {
+  unsigned int begin = block * RANGE_INDEX_BLOCK;
+  unsigned int end = size - begin > RANGE_INDEX_BLOCK
+                         ? begin + RANGE_INDEX_BLOCK
+                         : size;
+  return GetMinMax(array, begin, end);
+}
+
+// Диапазон короче двух блоков проще просканировать целиком
+static bool ScanIsCheaper(unsigned int begin, unsigned int end) {
+  return end - begin <= 2 * RANGE_INDEX_BLOCK;
+}
+
+struct SparseBuild {
+  struct SparseMinMax *index;
+  unsigned int level;
+};
+
+static void BuildSparseLeaves(void *ctx, size_t begin, size_t end) {
+  struct SparseMinMax *index = ((struct SparseBuild *)ctx)->index;
+  for (unsigned int b = begin; b < end; b++) {
+    index->table[0][b] = BlockSummary(index->array, index->size, b);
+  }
+}
+
+static void BuildSparseLevel(void *ctx, size_t begin, size_t end) {
+  struct SparseBuild *build = (struct SparseBuild *)ctx;
+  struct MinMax *prev = build->index->table[build->level - 1];
+  struct MinMax *cur = build->index->table[build->level];
+  unsigned int half = 1u << (build->level - 1);
+  for (unsigned int i = begin; i < end; i++) {
+    cur[i] = Merge(prev[i], prev[i + half]);
+  }
+}
+
+struct SparseMinMax *BuildSparseMinMax(int *array, unsigned int size,
+                                       int threads_num) {
+  if (size == 0) return NULL;
+
+  struct SparseMinMax *index = malloc(sizeof(struct SparseMinMax));
+  index->array = array;
+  index->size = size;
+  index->blocks = (size + RANGE_INDEX_BLOCK - 1) / RANGE_INDEX_BLOCK;
+  index->levels = FloorLog2(index->blocks) + 1;
+  index->table = malloc(index->levels * sizeof(struct MinMax *));
+  for (unsigned int k = 0; k < index->levels; k++) {
+    index->table[k] =
+        malloc((index->blocks - (1u << k) + 1) * sizeof(struct MinMax));
+  }
+
+  // Каждый уровень строится параллельно из предыдущего
+  struct SparseBuild build = {index, 0};
+  ParallelFor(index->blocks, INDEX_BUILD_GRAIN, threads_num, BuildSparseLeaves,
+              &build);
+  for (build.level = 1; build.level < index->levels; build.level++) {
+    ParallelFor(index->blocks - (1u << build.level) + 1, INDEX_BUILD_GRAIN,
+                threads_num,
+                BuildSparseLevel, &build);
+  }
+  return index;
+}
+
+struct MinMax QuerySparseMinMax(const struct SparseMinMax *index,
+                                unsigned int begin, unsigned int end) {
+  if (ScanIsCheaper(begin, end)) return GetMinMax(index->array, begin, end);
+
+  unsigned int first = (begin + RANGE_INDEX_BLOCK - 1) / RANGE_INDEX_BLOCK;
+  unsigned int last = end / RANGE_INDEX_BLOCK;
+  unsigned int k = FloorLog2(last - first);
+
+  struct MinMax result = Merge(index->table[k][first],
+                               index->table[k][last - (1u << k)]);
+  result = Merge(result,
+                 GetMinMax(index->array, begin, first * RANGE_INDEX_BLOCK));
+  return Merge(result, GetMinMax(index->array, last * RANGE_INDEX_BLOCK, end));
+}
+
+void FreeSparseMinMax(struct SparseMinMax *index) {
+  if (index == NULL) return;
+  for (unsigned int k = 0; k < index->levels; k++) free(index->table[k]);
+  free(index->table);
+  free(index);
+}
+
+static void BuildSegmentLeaves(void *ctx, size_t begin, size_t end) {
+  struct SegmentMinMax *tree = (struct SegmentMinMax *)ctx;
+  for (unsigned int b = begin; b < end; b++) {
+    tree->nodes[tree->blocks + b] = BlockSummary(tree->array, tree->size, b);
+  }
+}
+
+struct SegmentMinMax *BuildSegmentMinMax(int *array, unsigned int size,
+                                         int threads_num) {
+  if (size == 0) return NULL;
+
+  struct SegmentMinMax *tree = malloc(sizeof(struct SegmentMinMax));
+  tree->array = array;
+  tree->size = size;
+  tree->blocks = (size + RANGE_INDEX_BLOCK - 1) / RANGE_INDEX_BLOCK;
+  tree->nodes = malloc(2 * tree->blocks * sizeof(struct MinMax));
+
+  // Листья (сканирование всего массива) строятся параллельно, внутренние
+  // узлы - последовательно: их в RANGE_INDEX_BLOCK раз меньше, чем элементов
+  ParallelFor(tree->blocks, INDEX_BUILD_GRAIN, threads_num, BuildSegmentLeaves,
+              tree);
+  for (unsigned int i = tree->blocks - 1; i >= 1; i--) {
+    tree->nodes[i] = Merge(tree->nodes[2 * i], tree->nodes[2 * i + 1]);
+  }
+  return tree;
+}
+
+struct MinMax QuerySegmentMinMax(const struct SegmentMinMax *tree,
+                                 unsigned int begin, unsigned int end) {
+  if (ScanIsCheaper(begin, end)) return GetMinMax(tree->array, begin, end);
+
+  unsigned int first = (begin + RANGE_INDEX_BLOCK - 1) / RANGE_INDEX_BLOCK;
+  unsigned int last = end / RANGE_INDEX_BLOCK;
+
+  struct MinMax result = GetMinMax(tree->array, begin, first * RANGE_INDEX_BLOCK);
+  result = Merge(result, GetMinMax(tree->array, last * RANGE_INDEX_BLOCK, end));
+  for (first += tree->blocks, last += tree->blocks; first < last;
+       first >>= 1, last >>= 1) {
+    if (first & 1) result = Merge(result, tree->nodes[first++]);
+    if (last & 1) result = Merge(result, tree->nodes[--last]);
+  }
+  return result;
+}
+
+void UpdateSegmentMinMax(struct SegmentMinMax *tree, unsigned int position,
+                         int value) {
+  tree->array[position] = value;
+  unsigned int block = position / RANGE_INDEX_BLOCK;
+  unsigned int node = tree->blocks + block;
+  tree->nodes[node] = BlockSummary(tree->array, tree->size, block);
+  for (node >>= 1; node >= 1; node >>= 1) {
+    tree->nodes[node] = Merge(tree->nodes[2 * node], tree->nodes[2 * node + 1]);
+  }
+}
+
+void FreeSegmentMinMax(struct SegmentMinMax *tree) {
+  if (tree == NULL) return;
+  free(tree->nodes);
+  free(tree);
+}
@@ -0,0 +1,34 @@
+#ifndef RANGE_INDEX_H
+#define RANGE_INDEX_H
+
+#include "utils.h"
+
+// Индексы для многократных запросов min/max по диапазонам одного массива.
+// Массив делится на блоки по RANGE_INDEX_BLOCK элементов; индекс хранит
+// сводки блоков, а неполные блоки на краях запроса досчитываются GetMinMax.
+#define RANGE_INDEX_BLOCK 64
+
+// Разреженная таблица для неизменяемого массива: запрос за O(1)
+struct SparseMinMax;
+
+// Сегментное дерево по блокам: запрос и обновление за O(log n)
+struct SegmentMinMax;
+
+// threads_num <= 0 - по потоку на ядро. Массив не копируется и должен
+// жить дольше индекса.
+struct SparseMinMax *BuildSparseMinMax(int *array, unsigned int size,
+                                       int threads_num);
+struct MinMax QuerySparseMinMax(const struct SparseMinMax *index,
+                                unsigned int begin, unsigned int end);
+void FreeSparseMinMax(struct SparseMinMax *index);
+
+struct SegmentMinMax *BuildSegmentMinMax(int *array, unsigned int size,
+                                         int threads_num);
+struct MinMax QuerySegmentMinMax(const struct SegmentMinMax *tree,
+                                 unsigned int begin, unsigned int end);
+// Записывает value в array[position] и обновляет дерево
+void UpdateSegmentMinMax(struct SegmentMinMax *tree, unsigned int position,
+                         int value);
+void FreeSegmentMinMax(struct SegmentMinMax *tree);
+
+#endif
@@ -0,0 +1,260 @@
+#include "reduce.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "topology.h"
+
+#define STATE_ALIGN 64
+
+static size_t AlignState(size_t size) {
+  return (size + STATE_ALIGN - 1) / STATE_ALIGN * STATE_ALIGN;
+}
+
+// Общая память под все воркеры: у каждого статистика и состояния всех
+// операций, каждое с начала своей кэш-линии
+struct ReduceArea {
+  char *base;
+  size_t bytes;
+  size_t stride;
+  size_t *offsets;
+};
+
+static int CreateArea(struct ReduceArea *area, int workers,
+                      const struct ReduceOp *ops, int op_count) {
+  area->offsets = malloc(op_count * sizeof(size_t));
+  area->stride = AlignState(sizeof(struct ReduceWorkerStats));
+  for (int i = 0; i < op_count; i++) {
+    area->offsets[i] = area->stride;
+    area->stride += AlignState(ops[i].reducer->state_size);
+  }
+  area->bytes = area->stride * workers;
+  void *mem = mmap(NULL, area->bytes, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED) {
+    free(area->offsets);
+    return -1;
+  }
+  area->base = (char *)mem;
+  return 0;
+}
+
+static void DestroyArea(struct ReduceArea *area) {
+  munmap(area->base, area->bytes);
+  free(area->offsets);
+}
+
+static struct ReduceWorkerStats *WorkerStats(const struct ReduceArea *area,
+                                             int worker) {
+  return (struct ReduceWorkerStats *)(area->base + worker * area->stride);
+}
+
+static void *WorkerState(const struct ReduceArea *area, int worker, int op) {
+  return area->base + worker * area->stride + area->offsets[op];
+}
+
+struct ReduceTask {
+  const struct ReduceConfig *config;
+  const struct ReduceArea *area;
+  const struct ReduceOp *ops;
+  int op_count;
+  const int *array;
+  size_t size;
+  int worker;
+};
+
+// Срез воркера: одна операция получает его целиком (ее ядро само
+// векторизовано), несколько - блоками, чтобы данные читались из памяти один раз
+static void ReduceSlice(const struct ReduceTask *task) {
+  const struct ReduceConfig *config = task->config;
+  size_t segment = task->size / config->workers;
+  size_t begin = task->worker * segment;
+  size_t end = task->worker == config->workers - 1 ? task->size
+                                                   : begin + segment;
+  if (config->cpus) PinToCpu(config->cpus[task->worker]);
+
+  struct ReduceWorkerStats *stats = WorkerStats(task->area, task->worker);
+  void *states[task->op_count];
+  for (int i = 0; i < task->op_count; i++) {
+    states[i] = WorkerState(task->area, task->worker, i);
+    task->ops[i].reducer->init(states[i], task->ops[i].arg);
+  }
+
+  struct PerfCounters counters;
+  if (config->perf) StartPerfCounters(&counters);
+  stats->started_ns = MonotonicNs();
+  if (task->op_count == 1) {
+    task->ops[0].reducer->accumulate(states[0], task->array, begin, end,
+                                     task->ops[0].arg);
+  } else {
+    for (size_t block = begin; block < end; block += REDUCE_BLOCK) {
+      size_t stop = end - block > REDUCE_BLOCK ? block + REDUCE_BLOCK : end;
+      for (int i = 0; i < task->op_count; i++) {
+        task->ops[i].reducer->accumulate(states[i], task->array, block, stop,
+                                         task->ops[i].arg);
+      }
+    }
+  }
+  stats->finished_ns = MonotonicNs();
+  if (config->perf) StopPerfCounters(&counters, &stats->perf);
+  stats->elements = end - begin;
+}
+
+// Фазы прогона на шкалу, если она задана
+static int BeginPhase(struct Timeline *timeline, const char *name) {
+  return timeline ? BeginSpan(timeline, name, SPAN_NO_WORKER) : -1;
+}
+
+static void EndPhase(struct Timeline *timeline, int span) {
+  if (timeline) EndSpan(timeline, span);
+}
+
+static void *ReduceThread(void *arg) {
+  ReduceSlice((const struct ReduceTask *)arg);
+  return NULL;
+}
+
+// Процессы: fork() на воркера, состояния остаются в общей памяти
+static int RunProcessWorkers(struct ReduceTask *tasks, int workers,
+                             struct Timeline *timeline) {
+  pid_t *pids = malloc(workers * sizeof(pid_t));
+  int started = 0;
+  // Иначе дочерние процессы напечатают буфер stdout повторно
+  fflush(stdout);
+  int spawn_span = BeginPhase(timeline, "spawn");
+  for (int w = 0; w < workers; w++) {
+    pids[w] = fork();
+    if (pids[w] == -1) {
+      perror("fork failed");
+      break;
+    }
+    if (pids[w] == 0) {
+      ReduceSlice(&tasks[w]);
+      _exit(0);
+    }
+    started++;
+  }
+  EndPhase(timeline, spawn_span);
+
+  int failed = started < workers;
+  int wait_span = BeginPhase(timeline, "wait");
+  for (int w = 0; w < started; w++) {
+    int status;
+    if (waitpid(pids[w], &status, 0) == -1 || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != 0) {
+      failed = 1;
+    }
+  }
+  EndPhase(timeline, wait_span);
+  free(pids);
+  return failed ? -1 : 0;
+}
+
+static int RunThreadWorkers(struct ReduceTask *tasks, int workers,
+                            struct Timeline *timeline) {
+  pthread_t *threads = malloc(workers * sizeof(pthread_t));
+  int started = 0;
+  int spawn_span = BeginPhase(timeline, "spawn");
+  for (int w = 0; w < workers; w++) {
+    if (pthread_create(&threads[w], NULL, ReduceThread, &tasks[w])) {
+      printf("Error: pthread_create failed!\n");
+      break;
+    }
+    started++;
+  }
+  EndPhase(timeline, spawn_span);
+
+  int wait_span = BeginPhase(timeline, "wait");
+  for (int w = 0; w < started; w++) pthread_join(threads[w], NULL);
+  EndPhase(timeline, wait_span);
+  free(threads);
+  return started == workers ? 0 : -1;
+}
+
+int RunReduction(const struct ReduceConfig *config, const int *array,
+                 size_t size, const struct ReduceOp *ops, int op_count,
+                 struct ReduceResult *result) {
+  memset(result, 0, sizeof(*result));
+  struct ReduceArea area;
+  if (CreateArea(&area, config->workers, ops, op_count) == -1) {
+    perror("mmap failed");
+    return -1;
+  }
+  for (int w = 0; w < config->workers; w++) {
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+      WorkerStats(&area, w)->perf.value[c] = -1;
+    }
+  }
+
+  struct ReduceTask *tasks = malloc(config->workers * sizeof(struct ReduceTask));
+  for (int w = 0; w < config->workers; w++) {
+    tasks[w].config = config;
+    tasks[w].area = &area;
+    tasks[w].ops = ops;
+    tasks[w].op_count = op_count;
+    tasks[w].array = array;
+    tasks[w].size = size;
+    tasks[w].worker = w;
+  }
+
+  struct Timeline *timeline = config->timeline;
+  int status = config->backend == REDUCE_PROCESSES
+                   ? RunProcessWorkers(tasks, config->workers, timeline)
+                   : RunThreadWorkers(tasks, config->workers, timeline);
+  free(tasks);
+  if (status == -1) {
+    DestroyArea(&area);
+    return -1;
+  }
+
+  int aggregate_span = BeginPhase(timeline, "aggregate");
+  result->op_count = op_count;
+  result->states = malloc(op_count * sizeof(void *));
+  for (int i = 0; i < op_count; i++) {
+    const struct Reducer *reducer = ops[i].reducer;
+    result->states[i] = malloc(reducer->state_size);
+    reducer->init(result->states[i], ops[i].arg);
+    for (int w = 0; w < config->workers; w++) {
+      reducer->combine(result->states[i], WorkerState(&area, w, i), ops[i].arg);
+    }
+  }
+  EndPhase(timeline, aggregate_span);
+
+  result->stats = malloc(config->workers * sizeof(struct ReduceWorkerStats));
+  for (int w = 0; w < config->workers; w++) {
+    result->stats[w] = *WorkerStats(&area, w);
+    if (timeline) {
+      AddSpan(timeline, "compute", w, result->stats[w].started_ns,
+              result->stats[w].finished_ns);
+    }
+  }
+  DestroyArea(&area);
+  return 0;
+}
+
+void FreeReduceResult(struct ReduceResult *result) {
+  for (int i = 0; i < result->op_count; i++) free(result->states[i]);
+  free(result->states);
+  free(result->stats);
+}
+
+int ParseReduceBackend(const char *name, enum ReduceBackend *backend) {
+  if (strcmp(name, "processes") == 0) {
+    *backend = REDUCE_PROCESSES;
+  } else if (strcmp(name, "threads") == 0) {
+    *backend = REDUCE_THREADS;
+  } else {
+    return -1;
+  }
+  return 0;
+}
+
+const char *ReduceBackendName(enum ReduceBackend backend) {
+  return backend == REDUCE_PROCESSES ? "processes" : "threads";
+}
@@ -0,0 +1,77 @@
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "perf_counters.h"
+#include "timing.h"
+
+// Редьюсер: как свернуть срез массива в состояние фиксированного размера.
+// Состояние - плоский блок байт без указателей; это и есть его
+// сериализация: движок передает его от воркера родителю через общую
+// память, одинаково для процессов и потоков. arg - параметры операции.
+struct Reducer {
+  const char *name;
+  size_t state_size;
+  void (*init)(void *state, const void *arg);
+  void (*accumulate)(void *state, const int *array, size_t begin, size_t end,
+                     const void *arg);
+  // acc += part
+  void (*combine)(void *acc, const void *part, const void *arg);
+  // Итог в stdout в формате "Name: value"
+  void (*print)(const void *state, const void *arg);
+};
+
+struct ReduceOp {
+  const struct Reducer *reducer;
+  const void *arg;
+};
+
+// Несколько операций выполняются за один проход: срез воркера идет блоками
+// по REDUCE_BLOCK элементов, и каждый блок, пока он в кэше, получают все
+// редьюсеры по очереди
+#define REDUCE_BLOCK 8192
+
+enum ReduceBackend { REDUCE_PROCESSES, REDUCE_THREADS };
+
+struct ReduceConfig {
+  enum ReduceBackend backend;
+  int workers;
+  // cpus[i] - CPU i-го воркера, NULL - без привязки
+  const int *cpus;
+  // Счетчики perf_event_open в каждом воркере
+  bool perf;
+  // Сюда добавляются фазы spawn, wait, aggregate и compute по воркерам;
+  // NULL - без шкалы
+  struct Timeline *timeline;
+};
+
+struct ReduceWorkerStats {
+  size_t elements;
+  uint64_t started_ns;
+  uint64_t finished_ns;
+  struct PerfValues perf;
+};
+
+struct ReduceResult {
+  // states[i] - итоговое состояние i-й операции
+  void **states;
+  int op_count;
+  // Статистика по воркерам (config->workers штук)
+  struct ReduceWorkerStats *stats;
+};
+
+// Делит [0, size) поровну между воркерами, сворачивает каждый срез всеми
+// операциями и объединяет состояния; -1, если воркер не запустился или
+// завершился с ошибкой
+int RunReduction(const struct ReduceConfig *config, const int *array,
+                 size_t size, const struct ReduceOp *ops, int op_count,
+                 struct ReduceResult *result);
+void FreeReduceResult(struct ReduceResult *result);
+
+int ParseReduceBackend(const char *name, enum ReduceBackend *backend);
+const char *ReduceBackendName(enum ReduceBackend backend);
+
+#endif
@@ -0,0 +1,299 @@
+#include "reducers.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "find_min_max.h"
+#include "sum_lib.h"
+#include "zone_map.h"
+
+static void MinMaxInit(void *state, const void *arg) {
+  (void)arg;
+  struct MinMax *min_max = (struct MinMax *)state;
+  min_max->min = INT_MAX;
+  min_max->max = INT_MIN;
+}
+
+static void MinMaxAccumulate(void *state, const int *array, size_t begin,
+                             size_t end, const void *arg) {
+  (void)arg;
+  struct MinMax *acc = (struct MinMax *)state;
+  struct MinMax part = GetMinMax((int *)array, begin, end);
+  if (part.min < acc->min) acc->min = part.min;
+  if (part.max > acc->max) acc->max = part.max;
+}
+
+static void MinMaxCombine(void *acc, const void *part, const void *arg) {
+  (void)arg;
+  struct MinMax *total = (struct MinMax *)acc;
+  const struct MinMax *worker = (const struct MinMax *)part;
+  if (worker->min < total->min) total->min = worker->min;
+  if (worker->max > total->max) total->max = worker->max;
+}
+
+static void MinMaxPrint(const void *state, const void *arg) {
+  (void)arg;
+  const struct MinMax *min_max = (const struct MinMax *)state;
+  printf("Min: %d\n", min_max->min);
+  printf("Max: %d\n", min_max->max);
+}
+
+const struct Reducer min_max_reducer = {"min_max", sizeof(struct MinMax),
+                                        MinMaxInit, MinMaxAccumulate,
+                                        MinMaxCombine, MinMaxPrint};
+
+static void SumInit(void *state, const void *arg) {
+  (void)arg;
+  *(int64_t *)state = 0;
+}
+
+static void SumAccumulate(void *state, const int *array, size_t begin,
+                          size_t end, const void *arg) {
+  (void)arg;
+  struct SumArgs args = {(int *)array, begin, end};
+  *(int64_t *)state += Sum(&args);
+}
+
+static void SumCombine(void *acc, const void *part, const void *arg) {
+  (void)arg;
+  *(int64_t *)acc += *(const int64_t *)part;
+}
+
+static void SumPrint(const void *state, const void *arg) {
+  (void)arg;
+  printf("Sum: %lld\n", (long long)*(const int64_t *)state);
+}
+
+const struct Reducer sum_reducer = {"sum", sizeof(int64_t), SumInit,
+                                    SumAccumulate, SumCombine, SumPrint};
+
+static void CountInit(void *state, const void *arg) {
+  (void)arg;
+  *(uint64_t *)state = 0;
+}
+
+static void CountAccumulate(void *state, const int *array, size_t begin,
+                            size_t end, const void *arg) {
+  if (arg == NULL) {
+    *(uint64_t *)state += end - begin;
+    return;
+  }
+  // Сравнения без ветвлений: цикл векторизуется
+  const struct ValueFilter *filter = (const struct ValueFilter *)arg;
+  int lo = filter->lo, hi = filter->hi;
+  uint64_t count = 0;
+  for (size_t i = begin; i < end; i++) {
+    count += (array[i] >= lo) & (array[i] <= hi);
+  }
+  *(uint64_t *)state += count;
+}
+
+static void CountCombine(void *acc, const void *part, const void *arg) {
+  (void)arg;
+  *(uint64_t *)acc += *(const uint64_t *)part;
+}
+
+static void CountPrint(const void *state, const void *arg) {
+  (void)arg;
+  printf("Count: %llu\n", (unsigned long long)*(const uint64_t *)state);
+}
+
+const struct Reducer count_reducer = {"count", sizeof(uint64_t), CountInit,
+                                      CountAccumulate, CountCombine,
+                                      CountPrint};
+
+int InitHistogramSpec(struct HistogramSpec *spec, enum HistogramScale scale,
+                      int lo, int hi, unsigned int buckets) {
+  if (lo > hi) return -1;
+  uint64_t range = (uint64_t)((int64_t)hi - lo) + 1;
+  spec->scale = scale;
+  spec->lo = lo;
+  spec->hi = hi;
+  if (scale == HISTOGRAM_LOG) {
+    // Смещения [0, hi - lo]: корзина 0 и по корзине на каждый бит
+    uint32_t span = (uint32_t)(range - 1);
+    spec->buckets = span == 0 ? 1 : 33 - __builtin_clz(span);
+    spec->multiplier = 0;
+    return 0;
+  }
+  if (buckets == 0 || buckets > HISTOGRAM_MAX_BUCKETS || buckets > range) {
+    return -1;
+  }
+  // Множитель округлен вниз: (range - 1) * multiplier >> 32 < buckets, и
+  // последняя корзина не переполняется; buckets <= range, так что он >= 1
+  spec->buckets = buckets;
+  spec->multiplier = ((uint64_t)buckets << 32) / range;
+  return 0;
+}
+
+int HistogramBucketStart(const struct HistogramSpec *spec, unsigned int bucket) {
+  uint64_t offset;
+  if (spec->scale == HISTOGRAM_LOG) {
+    offset = bucket == 0 ? 0 : 1ULL << (bucket - 1);
+  } else {
+    // Наименьшее x с (x * multiplier) >> 32 >= bucket
+    offset = (((uint64_t)bucket << 32) + spec->multiplier - 1) / spec->multiplier;
+  }
+  // В int64: lo + offset может выйти за int, такая корзина начинается за hi
+  int64_t start = (int64_t)spec->lo + (int64_t)offset;
+  return start > spec->hi ? spec->hi : (int)start;
+}
+
+static void HistogramInit(void *state, const void *arg) {
+  (void)arg;
+  memset(state, 0, sizeof(struct HistogramCounts));
+}
+
+#define HISTOGRAM_CHUNK 256
+
+// Сначала номера корзин для куска без ветвлений (цикл векторизуется), затем
+// инкременты. Счетчики свои у каждого воркера, атомарные операции не нужны.
+static void HistogramAccumulate(void *state, const int *array, size_t begin,
+                                size_t end, const void *arg) {
+  const struct HistogramSpec *spec = (const struct HistogramSpec *)arg;
+  uint64_t *counts = ((struct HistogramCounts *)state)->counts;
+  uint32_t lo = (uint32_t)spec->lo;
+  uint32_t span = (uint32_t)spec->hi - lo;
+  uint32_t below = spec->buckets, above = spec->buckets + 1;
+  uint32_t index[HISTOGRAM_CHUNK];
+
+  for (size_t chunk = begin; chunk < end; chunk += HISTOGRAM_CHUNK) {
+    unsigned int n = end - chunk < HISTOGRAM_CHUNK ? end - chunk
+                                                   : HISTOGRAM_CHUNK;
+    const int *values = array + chunk;
+    if (spec->scale == HISTOGRAM_LINEAR) {
+      for (unsigned int i = 0; i < n; i++) {
+        uint32_t x = (uint32_t)values[i] - lo;
+        uint32_t bucket = (uint32_t)(((uint64_t)x * spec->multiplier) >> 32);
+        uint32_t outside = values[i] < spec->lo ? below : above;
+        index[i] = x <= span ? bucket : outside;
+      }
+    } else {
+      for (unsigned int i = 0; i < n; i++) {
+        uint32_t x = (uint32_t)values[i] - lo;
+        uint32_t bucket = (x != 0) * (32 - __builtin_clz(x | 1));
+        uint32_t outside = values[i] < spec->lo ? below : above;
+        index[i] = x <= span ? bucket : outside;
+      }
+    }
+    for (unsigned int i = 0; i < n; i++) counts[index[i]]++;
+  }
+}
+
+static void HistogramCombine(void *acc, const void *part, const void *arg) {
+  const struct HistogramSpec *spec = (const struct HistogramSpec *)arg;
+  uint64_t *total = ((struct HistogramCounts *)acc)->counts;
+  const uint64_t *worker = ((const struct HistogramCounts *)part)->counts;
+  for (unsigned int b = 0; b < spec->buckets + 2; b++) total[b] += worker[b];
+}
+
+static void HistogramPrint(const void *state, const void *arg) {
+  const struct HistogramSpec *spec = (const struct HistogramSpec *)arg;
+  const uint64_t *counts = ((const struct HistogramCounts *)state)->counts;
+  printf("Histogram: %s, %u buckets over [%d, %d]\n",
+         spec->scale == HISTOGRAM_LINEAR ? "linear" : "log", spec->buckets,
+         spec->lo, spec->hi);
+  for (unsigned int b = 0; b < spec->buckets; b++) {
+    int last = b + 1 < spec->buckets ? HistogramBucketStart(spec, b + 1) - 1
+                                     : spec->hi;
+    printf("Bucket %u [%d, %d]: %llu\n", b, HistogramBucketStart(spec, b), last,
+           (unsigned long long)counts[b]);
+  }
+  if (counts[spec->buckets] > 0) {
+    printf("Below %d: %llu\n", spec->lo,
+           (unsigned long long)counts[spec->buckets]);
+  }
+  if (counts[spec->buckets + 1] > 0) {
+    printf("Above %d: %llu\n", spec->hi,
+           (unsigned long long)counts[spec->buckets + 1]);
+  }
+}
+
+const struct Reducer histogram_reducer = {
+    "histogram", sizeof(struct HistogramCounts), HistogramInit,
+    HistogramAccumulate, HistogramCombine, HistogramPrint};
+
+static void RadixInit(void *state, const void *arg) {
+  (void)arg;
+  memset(state, 0, sizeof(struct RadixCounts));
+}
+
+// Локальные 32-битные счетчики сбрасываются в общие не реже, чем раз в
+// RADIX_CHUNK элементов, и не переполняются
+#define RADIX_CHUNK (1 << 24)
+
+static void RadixAccumulate(void *state, const int *array, size_t begin,
+                            size_t end, const void *arg) {
+  (void)arg;
+  struct RadixCounts *radix = (struct RadixCounts *)state;
+  // Две копии счетчиков по очереди: инкременты одного и того же байта в
+  // соседних элементах не ждут друг друга
+  uint32_t local[2][4][256];
+  for (size_t chunk = begin; chunk < end; chunk += RADIX_CHUNK) {
+    size_t stop = end - chunk > RADIX_CHUNK ? chunk + RADIX_CHUNK : end;
+    memset(local, 0, sizeof(local));
+    size_t i = chunk;
+    for (; stop - i >= 2; i += 2) {
+      uint32_t a = (uint32_t)array[i] ^ 0x80000000u;
+      uint32_t b = (uint32_t)array[i + 1] ^ 0x80000000u;
+      for (int pass = 0; pass < 4; pass++) {
+        local[0][pass][(a >> (8 * pass)) & 0xff]++;
+        local[1][pass][(b >> (8 * pass)) & 0xff]++;
+      }
+    }
+    if (i < stop) {
+      uint32_t a = (uint32_t)array[i] ^ 0x80000000u;
+      for (int pass = 0; pass < 4; pass++) local[0][pass][(a >> (8 * pass)) & 0xff]++;
+    }
+    for (int pass = 0; pass < 4; pass++) {
+      for (int b = 0; b < 256; b++) {
+        radix->counts[pass][b] += local[0][pass][b] + local[1][pass][b];
+      }
+    }
+  }
+}
+
+static void RadixCombine(void *acc, const void *part, const void *arg) {
+  (void)arg;
+  struct RadixCounts *total = (struct RadixCounts *)acc;
+  const struct RadixCounts *worker = (const struct RadixCounts *)part;
+  for (int pass = 0; pass < 4; pass++) {
+    for (int b = 0; b < 256; b++) total->counts[pass][b] += worker->counts[pass][b];
+  }
+}
+
+// По каждому байту: сколько корзин заняты и самая большая. Если одна
+// корзина содержит все элементы, проход сортировки по этому байту не нужен.
+static void RadixPrint(const void *state, const void *arg) {
+  (void)arg;
+  const struct RadixCounts *radix = (const struct RadixCounts *)state;
+  for (int pass = 0; pass < 4; pass++) {
+    unsigned int used = 0;
+    uint64_t largest = 0, total = 0;
+    for (int b = 0; b < 256; b++) {
+      uint64_t count = radix->counts[pass][b];
+      used += count > 0;
+      total += count;
+      if (count > largest) largest = count;
+    }
+    printf("Radix byte %d: %u non-empty buckets, largest %llu%s\n", pass, used,
+           (unsigned long long)largest,
+           largest == total ? " (pass can be skipped)" : "");
+  }
+}
+
+const struct Reducer radix_reducer = {"radix", sizeof(struct RadixCounts),
+                                      RadixInit, RadixAccumulate,
+                                      RadixCombine, RadixPrint};
+
+static const struct Reducer *const reducers[] = {
+    &min_max_reducer, &sum_reducer, &count_reducer, &histogram_reducer,
+    &radix_reducer};
+
+const struct Reducer *FindReducer(const char *name) {
+  for (size_t i = 0; i < sizeof(reducers) / sizeof(reducers[0]); i++) {
+    if (strcmp(reducers[i]->name, name) == 0) return reducers[i];
+  }
+  return NULL;
+}
@@ -0,0 +1,63 @@
+#ifndef REDUCERS_H
+#define REDUCERS_H
+
+#include "reduce.h"
+
+// Встроенные редьюсеры для RunReduction:
+// min_max - struct MinMax через SIMD-ядро GetMinMax,
+// sum - int64_t, без переполнения int,
+// count - uint64_t, число значений из [lo, hi]; arg - struct ValueFilter
+// или NULL (все элементы).
+extern const struct Reducer min_max_reducer;
+extern const struct Reducer sum_reducer;
+extern const struct Reducer count_reducer;
+
+// Гистограмма значений из [lo, hi]: равные корзины или логарифмические
+// (корзина 0 - само lo, корзина b >= 1 - смещения от lo из [2^(b-1), 2^b)).
+// Корзина считается без ветвлений и делений: смещение x = v - lo
+// умножается на 64-битный multiplier и сдвигается на 32 (x < 2^32,
+// multiplier <= 2^32, произведение помещается в 64 бита), так что границы
+// равных корзин верны с точностью до округления множителя на всем
+// диапазоне int.
+#define HISTOGRAM_MAX_BUCKETS 4096
+
+enum HistogramScale { HISTOGRAM_LINEAR, HISTOGRAM_LOG };
+
+struct HistogramSpec {
+  enum HistogramScale scale;
+  int lo;
+  int hi;
+  unsigned int buckets;
+  uint64_t multiplier;
+};
+
+// counts[b] для b < buckets - корзины; значения вне [lo, hi] попадают в
+// две служебные: counts[buckets] - ниже lo, counts[buckets + 1] - выше hi
+struct HistogramCounts {
+  uint64_t counts[HISTOGRAM_MAX_BUCKETS + 2];
+};
+
+// Счетчики по каждому байту ключа (значение с инвертированным знаковым
+// битом, так что порядок ключей совпадает с порядком int): готовые
+// гистограммы для проходов поразрядной сортировки
+struct RadixCounts {
+  uint64_t counts[4][256];
+};
+
+// buckets для log игнорируется (хватает, чтобы покрыть hi - lo); -1, если
+// lo > hi или равных корзин больше, чем значений
+int InitHistogramSpec(struct HistogramSpec *spec, enum HistogramScale scale,
+                      int lo, int hi, unsigned int buckets);
+// Наименьшее значение, попадающее в корзину bucket
+int HistogramBucketStart(const struct HistogramSpec *spec, unsigned int bucket);
+
+// histogram - struct HistogramCounts, arg - struct HistogramSpec;
+// radix - struct RadixCounts, без arg
+extern const struct Reducer histogram_reducer;
+extern const struct Reducer radix_reducer;
+
+// Редьюсер по имени ("min_max", "sum", "count", "histogram", "radix");
+// NULL, если такого нет
+const struct Reducer *FindReducer(const char *name);
+
+#endif
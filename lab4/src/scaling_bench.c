@@ -0,0 +1,435 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <getopt.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+// Прогоняет готовые бинарники лабораторных по сетке (инструмент, способ
+// передачи, размер массива, число воркеров) и собирает их собственное
+// "Elapsed time" - генерация массива в замер не входит. У
+// sequential_min_max замера нет, поэтому берется его интервал compute
+// из --timing text.
+
+#define MAX_LIST 32
+#define OUTPUT_SIZE 65536
+
+enum Tool { TOOL_PARALLEL_MIN_MAX, TOOL_PARALLEL_SUM, TOOL_SEQUENTIAL };
+
+static const char *tool_names[] = {"parallel_min_max", "parallel_sum",
+                                   "sequential_min_max"};
+
+// Способы передачи результата parallel_min_max (threads - режим потоков)
+static const char *transport_names[] = {"pipe", "files", "shm", "threads"};
+
+struct Config {
+  enum Tool tool;
+  const char *transport;
+  unsigned long size;
+  int workers;
+};
+
+struct Stats {
+  double median;
+  double p95;
+  double p99;
+  double mean;
+  double speedup;
+  double efficiency;
+};
+
+struct Options {
+  unsigned long sizes[MAX_LIST];
+  int size_count;
+  int workers[MAX_LIST];
+  int worker_count;
+  const char *transports[MAX_LIST];
+  int transport_count;
+  bool tools[3];
+  int warmup;
+  int repeats;
+  int seed;
+  const char *lab3_dir;
+  const char *lab4_dir;
+  const char *csv;
+  const char *json;
+};
+
+// Разбивает "a,b,c" на части; строка меняется на месте
+static int SplitList(char *list, char **items) {
+  int count = 0;
+  for (char *item = strtok(list, ","); item != NULL && count < MAX_LIST;
+       item = strtok(NULL, ",")) {
+    items[count++] = item;
+  }
+  return count;
+}
+
+// Индекс name в names или -1
+static int FindName(const char *name, const char *const *names, int count) {
+  for (int i = 0; i < count; i++) {
+    if (strcmp(name, names[i]) == 0) return i;
+  }
+  return -1;
+}
+
+// Запускает бинарник, собирает его stdout и достает время в мс; -1 при ошибке
+static double RunOnce(char *const *argv, bool sequential) {
+  int pipefd[2];
+  if (pipe(pipefd) == -1) return -1;
+
+  pid_t pid = fork();
+  if (pid == -1) {
+    close(pipefd[0]);
+    close(pipefd[1]);
+    return -1;
+  }
+  if (pid == 0) {
+    dup2(pipefd[1], STDOUT_FILENO);
+    close(pipefd[0]);
+    close(pipefd[1]);
+    execv(argv[0], argv);
+    _exit(127);
+  }
+  close(pipefd[1]);
+
+  static char output[OUTPUT_SIZE];
+  size_t length = 0;
+  ssize_t got;
+  while (length < OUTPUT_SIZE - 1 &&
+         (got = read(pipefd[0], output + length, OUTPUT_SIZE - 1 - length)) > 0) {
+    length += got;
+  }
+  output[length] = '\0';
+  // Остаток вывода сверх буфера вычитываем и выбрасываем, иначе ребенок
+  // заблокируется на полном пайпе, а waitpid - на нем
+  char discard[4096];
+  while (read(pipefd[0], discard, sizeof(discard)) > 0) {
+  }
+  close(pipefd[0]);
+
+  int status;
+  waitpid(pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) return -1;
+
+  // В режиме compare печатается несколько прогонов - берем первый
+  double ms;
+  if (sequential) {
+    char *line = strstr(output, "\ncompute");
+    int worker;
+    double start;
+    if (line && sscanf(line, " compute %d %lf %lf", &worker, &start, &ms) == 3) {
+      return ms;
+    }
+  } else {
+    char *line = strstr(output, "Elapsed time: ");
+    if (line && sscanf(line, "Elapsed time: %lf", &ms) == 1) return ms;
+  }
+  return -1;
+}
+
+static void BuildArgs(const struct Options *options, const struct Config *config,
+                      char *path, char **argv, char storage[][32]) {
+  int argc = 0;
+  snprintf(storage[0], 32, "%d", options->seed);
+  snprintf(storage[1], 32, "%lu", config->size);
+  snprintf(storage[2], 32, "%d", config->workers);
+
+  if (config->tool == TOOL_SEQUENTIAL) {
+    snprintf(path, 512, "%s/sequential_min_max", options->lab3_dir);
+    argv[argc++] = path;
+    argv[argc++] = storage[0];
+    argv[argc++] = storage[1];
+    argv[argc++] = "--timing";
+    argv[argc++] = "text";
+  } else if (config->tool == TOOL_PARALLEL_SUM) {
+    snprintf(path, 512, "%s/parallel_sum", options->lab4_dir);
+    argv[argc++] = path;
+    argv[argc++] = "--seed";
+    argv[argc++] = storage[0];
+    argv[argc++] = "--array_size";
+    argv[argc++] = storage[1];
+    argv[argc++] = "--threads_num";
+    argv[argc++] = storage[2];
+  } else {
+    snprintf(path, 512, "%s/parallel_min_max", options->lab4_dir);
+    argv[argc++] = path;
+    argv[argc++] = "--seed";
+    argv[argc++] = storage[0];
+    argv[argc++] = "--array_size";
+    argv[argc++] = storage[1];
+    argv[argc++] = "--pnum";
+    argv[argc++] = storage[2];
+    if (strcmp(config->transport, "files") == 0) {
+      argv[argc++] = "--by_files";
+    } else if (strcmp(config->transport, "shm") == 0) {
+      argv[argc++] = "--by_shm";
+    } else if (strcmp(config->transport, "threads") == 0) {
+      argv[argc++] = "--mode";
+      argv[argc++] = "threads";
+    }
+  }
+  argv[argc] = NULL;
+}
+
+static int CompareDouble(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+// Перцентиль по ближайшему рангу: на малом числе повторов p99 = максимум
+static double Percentile(const double *sorted, int count, double p) {
+  int rank = (int)(p / 100.0 * count + 0.999999);
+  if (rank < 1) rank = 1;
+  if (rank > count) rank = count;
+  return sorted[rank - 1];
+}
+
+static bool Measure(const struct Options *options, const struct Config *config,
+                    struct Stats *stats) {
+  char path[512];
+  char storage[3][32];
+  char *argv[16];
+  BuildArgs(options, config, path, argv, storage);
+
+  for (int i = 0; i < options->warmup; i++) {
+    if (RunOnce(argv, config->tool == TOOL_SEQUENTIAL) < 0) return false;
+  }
+  double samples[options->repeats];
+  double sum = 0;
+  for (int i = 0; i < options->repeats; i++) {
+    samples[i] = RunOnce(argv, config->tool == TOOL_SEQUENTIAL);
+    if (samples[i] < 0) return false;
+    sum += samples[i];
+  }
+  qsort(samples, options->repeats, sizeof(double), CompareDouble);
+  int n = options->repeats;
+  stats->median = n % 2 ? samples[n / 2]
+                        : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+  stats->p95 = Percentile(samples, n, 95);
+  stats->p99 = Percentile(samples, n, 99);
+  stats->mean = sum / n;
+  return true;
+}
+
+int main(int argc, char **argv) {
+  struct Options options;
+  memset(&options, 0, sizeof(options));
+  options.warmup = 1;
+  options.repeats = 5;
+  options.seed = 1;
+  options.lab3_dir = "../../lab3/src";
+  options.lab4_dir = ".";
+  char default_sizes[] = "1000000,10000000";
+  char default_workers[] = "1,2,4,8";
+  char default_transports[] = "pipe,files,shm,threads";
+  char default_tools[] = "parallel_min_max,parallel_sum,sequential_min_max";
+  char *sizes = default_sizes, *workers = default_workers;
+  char *transports = default_transports, *tools = default_tools;
+
+  static struct option long_options[] = {
+      {"sizes", required_argument, 0, 0},
+      {"workers", required_argument, 0, 0},
+      {"transports", required_argument, 0, 0},
+      {"tools", required_argument, 0, 0},
+      {"warmup", required_argument, 0, 0},
+      {"repeats", required_argument, 0, 0},
+      {"seed", required_argument, 0, 0},
+      {"lab3_dir", required_argument, 0, 0},
+      {"lab4_dir", required_argument, 0, 0},
+      {"csv", required_argument, 0, 0},
+      {"json", required_argument, 0, 0},
+      {0, 0, 0, 0}};
+
+  while (true) {
+    int option_index = 0;
+    int c = getopt_long(argc, argv, "", long_options, &option_index);
+    if (c == -1) break;
+    if (c != 0) {
+      printf("Usage: %s [--sizes n,...] [--workers n,...] "
+             "[--transports pipe,files,shm,threads] [--tools name,...] "
+             "[--warmup n] [--repeats n] [--seed n] [--lab3_dir dir] "
+             "[--lab4_dir dir] [--csv file] [--json file]\n",
+             argv[0]);
+      return 1;
+    }
+    switch (option_index) {
+      case 0: sizes = optarg; break;
+      case 1: workers = optarg; break;
+      case 2: transports = optarg; break;
+      case 3: tools = optarg; break;
+      case 4: options.warmup = atoi(optarg); break;
+      case 5: options.repeats = atoi(optarg); break;
+      case 6: options.seed = atoi(optarg); break;
+      case 7: options.lab3_dir = optarg; break;
+      case 8: options.lab4_dir = optarg; break;
+      case 9: options.csv = optarg; break;
+      case 10: options.json = optarg; break;
+    }
+  }
+  if (options.repeats <= 0 || options.warmup < 0 || options.seed <= 0) {
+    printf("repeats and seed must be positive, warmup non-negative\n");
+    return 1;
+  }
+
+  char *items[MAX_LIST];
+  options.size_count = SplitList(sizes, items);
+  for (int i = 0; i < options.size_count; i++) {
+    char *end;
+    options.sizes[i] = strtoul(items[i], &end, 10);
+    if (items[i][0] == '-' || *end != '\0' || options.sizes[i] == 0) {
+      printf("invalid size \"%s\": sizes must be positive integers\n",
+             items[i]);
+      return 1;
+    }
+  }
+  options.worker_count = SplitList(workers, items);
+  for (int i = 0; i < options.worker_count; i++) {
+    options.workers[i] = atoi(items[i]);
+    if (options.workers[i] <= 0) {
+      printf("worker counts must be positive\n");
+      return 1;
+    }
+  }
+  options.transport_count = SplitList(transports, (char **)options.transports);
+  for (int i = 0; i < options.transport_count; i++) {
+    if (FindName(options.transports[i], transport_names, 4) == -1) {
+      printf("unknown transport \"%s\": expected pipe, files, shm or threads\n",
+             options.transports[i]);
+      return 1;
+    }
+  }
+  int tool_count = SplitList(tools, items);
+  for (int i = 0; i < tool_count; i++) {
+    int t = FindName(items[i], tool_names, 3);
+    if (t == -1) {
+      printf("unknown tool \"%s\": expected parallel_min_max, parallel_sum "
+             "or sequential_min_max\n",
+             items[i]);
+      return 1;
+    }
+    options.tools[t] = true;
+  }
+
+  // Строим сетку: у parallel_sum единственный способ - потоки, у
+  // sequential_min_max один воркер
+  int max_configs = 3 * MAX_LIST * MAX_LIST * MAX_LIST;
+  struct Config *configs = malloc(max_configs * sizeof(struct Config));
+  struct Stats *stats = malloc(max_configs * sizeof(struct Stats));
+  bool *ok = malloc(max_configs * sizeof(bool));
+  int count = 0;
+  for (int s = 0; s < options.size_count; s++) {
+    if (options.tools[TOOL_SEQUENTIAL]) {
+      configs[count++] =
+          (struct Config){TOOL_SEQUENTIAL, "-", options.sizes[s], 1};
+    }
+    for (int t = 0; t < options.transport_count; t++) {
+      for (int w = 0; w < options.worker_count; w++) {
+        if (options.tools[TOOL_PARALLEL_MIN_MAX]) {
+          configs[count++] = (struct Config){
+              TOOL_PARALLEL_MIN_MAX, options.transports[t], options.sizes[s],
+              options.workers[w]};
+        }
+      }
+    }
+    for (int w = 0; w < options.worker_count; w++) {
+      if (options.tools[TOOL_PARALLEL_SUM]) {
+        configs[count++] = (struct Config){TOOL_PARALLEL_SUM, "threads",
+                                           options.sizes[s], options.workers[w]};
+      }
+    }
+  }
+
+  for (int i = 0; i < count; i++) {
+    ok[i] = Measure(&options, &configs[i], &stats[i]);
+    if (!ok[i]) {
+      fprintf(stderr, "%s %s size %lu workers %d failed\n",
+              tool_names[configs[i].tool], configs[i].transport,
+              configs[i].size, configs[i].workers);
+    }
+  }
+
+  // Ускорение - относительно прогона той же серии (инструмент, способ,
+  // размер) с наименьшим числом воркеров, приведенного к одному воркеру
+  for (int i = 0; i < count; i++) {
+    if (!ok[i]) continue;
+    int base = i;
+    for (int j = 0; j < count; j++) {
+      if (ok[j] && configs[j].tool == configs[i].tool &&
+          configs[j].size == configs[i].size &&
+          strcmp(configs[j].transport, configs[i].transport) == 0 &&
+          configs[j].workers < configs[base].workers) {
+        base = j;
+      }
+    }
+    stats[i].speedup = stats[base].median / stats[i].median;
+    stats[i].efficiency = stats[i].speedup * configs[base].workers /
+                          configs[i].workers;
+  }
+
+  printf("%-20s %-9s %12s %7s %10s %10s %10s %8s %10s\n", "tool", "transport",
+         "size", "workers", "median ms", "p95 ms", "p99 ms", "speedup",
+         "efficiency");
+  for (int i = 0; i < count; i++) {
+    if (!ok[i]) continue;
+    printf("%-20s %-9s %12lu %7d %10.3f %10.3f %10.3f %8.2f %10.2f\n",
+           tool_names[configs[i].tool], configs[i].transport, configs[i].size,
+           configs[i].workers, stats[i].median, stats[i].p95, stats[i].p99,
+           stats[i].speedup, stats[i].efficiency);
+  }
+
+  if (options.csv) {
+    FILE *csv = fopen(options.csv, "w");
+    if (csv == NULL) {
+      perror("csv");
+    } else {
+      fprintf(csv, "tool,transport,size,workers,median_ms,p95_ms,p99_ms,"
+                   "mean_ms,speedup,efficiency\n");
+      for (int i = 0; i < count; i++) {
+        if (!ok[i]) continue;
+        fprintf(csv, "%s,%s,%lu,%d,%.6f,%.6f,%.6f,%.6f,%.4f,%.4f\n",
+                tool_names[configs[i].tool], configs[i].transport,
+                configs[i].size, configs[i].workers, stats[i].median,
+                stats[i].p95, stats[i].p99, stats[i].mean, stats[i].speedup,
+                stats[i].efficiency);
+      }
+      fclose(csv);
+    }
+  }
+
+  if (options.json) {
+    FILE *json = fopen(options.json, "w");
+    if (json == NULL) {
+      perror("json");
+    } else {
+      fprintf(json, "{\"warmup\": %d, \"repeats\": %d, \"results\": [",
+              options.warmup, options.repeats);
+      bool first = true;
+      for (int i = 0; i < count; i++) {
+        if (!ok[i]) continue;
+        fprintf(json,
+                "%s\n  {\"tool\": \"%s\", \"transport\": \"%s\", "
+                "\"size\": %lu, \"workers\": %d, \"median_ms\": %.6f, "
+                "\"p95_ms\": %.6f, \"p99_ms\": %.6f, \"mean_ms\": %.6f, "
+                "\"speedup\": %.4f, \"efficiency\": %.4f}",
+                first ? "" : ",", tool_names[configs[i].tool],
+                configs[i].transport, configs[i].size, configs[i].workers,
+                stats[i].median, stats[i].p95, stats[i].p99, stats[i].mean,
+                stats[i].speedup, stats[i].efficiency);
+        first = false;
+      }
+      fprintf(json, "\n]}\n");
+      fclose(json);
+    }
+  }
+
+  int failed = 0;
+  for (int i = 0; i < count; i++) failed += !ok[i];
+  free(configs);
+  free(stats);
+  free(ok);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,381 @@
+#include "sort_lib.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Элементов выборки на поток при выборе разделителей sample sort
+#define SAMPLE_OVERSAMPLING 32
+
+// Срез потока t: тот же раздел поровну, что и у воркеров parallel_min_max
+static void SliceOf(size_t size, int threads, size_t t, size_t *begin,
+                    size_t *end) {
+  size_t segment = size / threads;
+  *begin = t * segment;
+  *end = t == (size_t)threads - 1 ? size : *begin + segment;
+}
+
+// fn(ctx, t, t + 1) для каждого t из [0, threads), по потоку на t
+static void ForEachThread(int threads, RangeFn fn, void *ctx) {
+  ParallelFor(threads, 1, threads, fn, ctx);
+}
+
+static int CompareInts(const void *a, const void *b) {
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+struct CopyTask {
+  char *to;
+  const char *from;
+  size_t count;
+  size_t size;
+  int threads;
+};
+
+static void CopySlice(void *ctx, size_t first, size_t last) {
+  const struct CopyTask *task = ctx;
+  for (size_t t = first; t < last; t++) {
+    size_t begin, end;
+    SliceOf(task->count, task->threads, t, &begin, &end);
+    memcpy(task->to + begin * task->size, task->from + begin * task->size,
+           (end - begin) * task->size);
+  }
+}
+
+// Параллельное копирование: буфер обратно в массив
+static void CopyBack(void *to, const void *from, size_t count, size_t size,
+                     int threads) {
+  struct CopyTask task = {to, from, count, size, threads};
+  ForEachThread(threads, CopySlice, &task);
+}
+
+struct RadixPass {
+  const int *from;
+  int *to;
+  size_t size;
+  int threads;
+  uint32_t min;
+  int shift;
+  uint32_t mask;
+  size_t buckets;
+  // threads * buckets: сначала счетчики срезов, затем позиции записи
+  size_t *counts;
+};
+
+static void RadixCount(void *ctx, size_t first, size_t last) {
+  const struct RadixPass *pass = ctx;
+  for (size_t t = first; t < last; t++) {
+    size_t begin, end;
+    SliceOf(pass->size, pass->threads, t, &begin, &end);
+    size_t *counts = pass->counts + t * pass->buckets;
+    memset(counts, 0, pass->buckets * sizeof(size_t));
+    for (size_t i = begin; i < end; i++) {
+      counts[(((uint32_t)pass->from[i] - pass->min) >> pass->shift) & pass->mask]++;
+    }
+  }
+}
+
+static void RadixScatter(void *ctx, size_t first, size_t last) {
+  const struct RadixPass *pass = ctx;
+  for (size_t t = first; t < last; t++) {
+    size_t begin, end;
+    SliceOf(pass->size, pass->threads, t, &begin, &end);
+    size_t *offsets = pass->counts + t * pass->buckets;
+    for (size_t i = begin; i < end; i++) {
+      int value = pass->from[i];
+      pass->to[offsets[(((uint32_t)value - pass->min) >> pass->shift) &
+                       pass->mask]++] = value;
+    }
+  }
+}
+
+// Счетчики срезов -> позиции записи: корзина за корзиной, внутри корзины
+// срезы по порядку, так что проход устойчив. false, если все ключи в
+// одной корзине и проход ничего не меняет.
+static bool RadixOffsets(struct RadixPass *pass) {
+  size_t offset = 0;
+  for (size_t d = 0; d < pass->buckets; d++) {
+    size_t total = 0;
+    for (int t = 0; t < pass->threads; t++) {
+      size_t *count = pass->counts + t * pass->buckets + d;
+      size_t n = *count;
+      *count = offset + total;
+      total += n;
+    }
+    if (total == pass->size) return false;
+    offset += total;
+  }
+  return true;
+}
+
+int RadixSort(int *array, int *buffer, size_t size, struct MinMax range,
+              int threads) {
+  uint32_t span = (uint32_t)range.max - (uint32_t)range.min;
+  int bits = span ? 32 - __builtin_clz(span) : 0;
+  int passes = (bits + RADIX_MAX_BITS - 1) / RADIX_MAX_BITS;
+  if (passes == 0) return 0;
+  int digit = (bits + passes - 1) / passes;
+
+  struct RadixPass pass;
+  pass.size = size;
+  pass.threads = threads;
+  pass.min = (uint32_t)range.min;
+  pass.mask = (1u << digit) - 1;
+  pass.buckets = (size_t)1 << digit;
+  pass.counts = malloc(threads * pass.buckets * sizeof(size_t));
+
+  int *from = array, *to = buffer;
+  int done = 0;
+  for (int p = 0; p < passes; p++) {
+    pass.from = from;
+    pass.to = to;
+    pass.shift = p * digit;
+    ForEachThread(threads, RadixCount, &pass);
+    if (!RadixOffsets(&pass)) continue;
+    ForEachThread(threads, RadixScatter, &pass);
+    int *swap = from;
+    from = to;
+    to = swap;
+    done++;
+  }
+  free(pass.counts);
+
+  if (from != array) CopyBack(array, from, size, sizeof(int), threads);
+  return done;
+}
+
+struct SampleTask {
+  char *base;
+  char *buffer;
+  size_t count;
+  size_t size;
+  int (*compare)(const void *, const void *);
+  int threads;
+  // threads - 1 разделителей подряд
+  const char *splitters;
+  // threads * threads: счетчики корзин по срезам, затем позиции записи
+  size_t *counts;
+  // Начала корзин в buffer, threads + 1 штук
+  size_t *starts;
+};
+
+// Номер корзины: сколько разделителей не больше элемента
+static size_t BucketOf(const struct SampleTask *task, const void *item) {
+  size_t lo = 0, hi = task->threads - 1;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (task->compare(task->splitters + mid * task->size, item) <= 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+static void SampleCount(void *ctx, size_t first, size_t last) {
+  const struct SampleTask *task = ctx;
+  for (size_t t = first; t < last; t++) {
+    size_t begin, end;
+    SliceOf(task->count, task->threads, t, &begin, &end);
+    size_t *counts = task->counts + t * task->threads;
+    memset(counts, 0, task->threads * sizeof(size_t));
+    for (size_t i = begin; i < end; i++) {
+      counts[BucketOf(task, task->base + i * task->size)]++;
+    }
+  }
+}
+
+// Классификация повторяется вместо хранения номеров корзин: это
+// log2(threads) сравнений на элемент без лишнего массива размера count
+static void SampleScatter(void *ctx, size_t first, size_t last) {
+  const struct SampleTask *task = ctx;
+  for (size_t t = first; t < last; t++) {
+    size_t begin, end;
+    SliceOf(task->count, task->threads, t, &begin, &end);
+    size_t *offsets = task->counts + t * task->threads;
+    for (size_t i = begin; i < end; i++) {
+      const char *item = task->base + i * task->size;
+      memcpy(task->buffer + offsets[BucketOf(task, item)]++ * task->size, item,
+             task->size);
+    }
+  }
+}
+
+// Корзина b сортируется в буфере и копируется на то же место в массиве
+static void SampleSortBuckets(void *ctx, size_t first, size_t last) {
+  const struct SampleTask *task = ctx;
+  for (size_t b = first; b < last; b++) {
+    size_t begin = task->starts[b], end = task->starts[b + 1];
+    qsort(task->buffer + begin * task->size, end - begin, task->size,
+          task->compare);
+    memcpy(task->base + begin * task->size, task->buffer + begin * task->size,
+           (end - begin) * task->size);
+  }
+}
+
+void SampleSort(void *base, void *buffer, size_t count, size_t size,
+                int (*compare)(const void *, const void *), int threads) {
+  size_t sample_count = (size_t)threads * SAMPLE_OVERSAMPLING;
+  if (threads == 1 || count < 2 * sample_count) {
+    qsort(base, count, size, compare);
+    return;
+  }
+
+  // Выборка по псевдослучайным позициям (xorshift64), чтобы
+  // периодичность данных не сдвигала разделители
+  char *sample = malloc(sample_count * size);
+  uint64_t rng = 0x9e3779b97f4a7c15ULL;
+  for (size_t i = 0; i < sample_count; i++) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    memcpy(sample + i * size, (char *)base + (rng % count) * size, size);
+  }
+  qsort(sample, sample_count, size, compare);
+  char *splitters = malloc((threads - 1) * size);
+  for (int b = 0; b < threads - 1; b++) {
+    memcpy(splitters + b * size,
+           sample + (size_t)(b + 1) * SAMPLE_OVERSAMPLING * size, size);
+  }
+  free(sample);
+
+  struct SampleTask task;
+  task.base = base;
+  task.buffer = buffer;
+  task.count = count;
+  task.size = size;
+  task.compare = compare;
+  task.threads = threads;
+  task.splitters = splitters;
+  task.counts = malloc((size_t)threads * threads * sizeof(size_t));
+  task.starts = malloc((threads + 1) * sizeof(size_t));
+
+  ForEachThread(threads, SampleCount, &task);
+  size_t offset = 0;
+  for (int b = 0; b < threads; b++) {
+    task.starts[b] = offset;
+    for (int t = 0; t < threads; t++) {
+      size_t *counter = task.counts + (size_t)t * threads + b;
+      size_t n = *counter;
+      *counter = offset;
+      offset += n;
+    }
+  }
+  task.starts[threads] = count;
+  ForEachThread(threads, SampleScatter, &task);
+  ForEachThread(threads, SampleSortBuckets, &task);
+
+  free(task.counts);
+  free(task.starts);
+  free(splitters);
+}
+
+// Сколько элементов a среди первых k элементов слияния a и b (при
+// равенстве первым идет элемент a)
+static size_t CoRank(size_t k, const int *a, size_t m, const int *b,
+                     size_t n) {
+  size_t lo = k > n ? k - n : 0;
+  size_t hi = k < m ? k : m;
+  while (lo < hi) {
+    size_t i = lo + (hi - lo) / 2;
+    if (a[i] <= b[k - i - 1]) {
+      lo = i + 1;
+    } else {
+      hi = i;
+    }
+  }
+  return lo;
+}
+
+// Слияние без ветвлений по исходу сравнения: на случайных данных оно
+// плохо предсказывается
+static void MergeRuns(const int *a, size_t m, const int *b, size_t n,
+                      int *out) {
+  size_t i = 0, j = 0;
+  while (i < m && j < n) {
+    int take_b = b[j] < a[i];
+    *out++ = take_b ? b[j] : a[i];
+    j += take_b;
+    i += 1 - take_b;
+  }
+  memcpy(out, a + i, (m - i) * sizeof(int));
+  memcpy(out + (m - i), b + j, (n - j) * sizeof(int));
+}
+
+struct MergeTask {
+  int *array;
+  const int *from;
+  int *to;
+  size_t size;
+  int threads;
+  // Границы отсортированных серий, runs + 1 штук
+  size_t *bounds;
+  int runs;
+};
+
+static void SortSlice(void *ctx, size_t first, size_t last) {
+  const struct MergeTask *task = ctx;
+  for (size_t t = first; t < last; t++) {
+    size_t begin, end;
+    SliceOf(task->size, task->threads, t, &begin, &end);
+    qsort(task->array + begin, end - begin, sizeof(int), CompareInts);
+  }
+}
+
+// Поток t пишет свою долю выхода раунда: в каждом пересекающемся с ней
+// слиянии пары серий находит границы входа через CoRank
+static void MergeSlice(void *ctx, size_t first, size_t last) {
+  const struct MergeTask *task = ctx;
+  for (size_t t = first; t < last; t++) {
+    size_t lo, hi;
+    SliceOf(task->size, task->threads, t, &lo, &hi);
+    for (int p = 0; 2 * p < task->runs; p++) {
+      size_t start = task->bounds[2 * p];
+      size_t middle = task->bounds[2 * p + 1];
+      size_t stop = task->bounds[2 * p + 2 < task->runs ? 2 * p + 2 : task->runs];
+      if (stop <= lo || start >= hi) continue;
+
+      const int *a = task->from + start, *b = task->from + middle;
+      size_t m = middle - start, n = stop - middle;
+      size_t k0 = (lo > start ? lo : start) - start;
+      size_t k1 = (hi < stop ? hi : stop) - start;
+      size_t i0 = CoRank(k0, a, m, b, n), i1 = CoRank(k1, a, m, b, n);
+      MergeRuns(a + i0, i1 - i0, b + (k0 - i0), (k1 - i1) - (k0 - i0),
+                task->to + start + k0);
+    }
+  }
+}
+
+void MergeSort(int *array, int *buffer, size_t size, int threads) {
+  struct MergeTask task;
+  task.array = array;
+  task.size = size;
+  task.threads = threads;
+  task.runs = threads;
+  task.bounds = malloc((threads + 1) * sizeof(size_t));
+  for (int t = 0; t < threads; t++) {
+    size_t end;
+    SliceOf(size, threads, t, &task.bounds[t], &end);
+  }
+  task.bounds[threads] = size;
+  ForEachThread(threads, SortSlice, &task);
+
+  int *from = array, *to = buffer;
+  while (task.runs > 1) {
+    task.from = from;
+    task.to = to;
+    ForEachThread(threads, MergeSlice, &task);
+    int runs = (task.runs + 1) / 2;
+    for (int p = 0; p < runs; p++) task.bounds[p] = task.bounds[2 * p];
+    task.bounds[runs] = size;
+    task.runs = runs;
+    int *swap = from;
+    from = to;
+    to = swap;
+  }
+  free(task.bounds);
+
+  if (from != array) CopyBack(array, from, size, sizeof(int), threads);
+}
@@ -0,0 +1,37 @@
+#ifndef SORT_LIB_H
+#define SORT_LIB_H
+
+#include <stddef.h>
+
+#include "utils.h"
+
+// Параллельные сортировки. Массив делится на threads равных срезов, как в
+// parallel_min_max; каждая фаза - отдельный ParallelFor по потоку на срез.
+// buffer - вспомогательная память того же размера, что и массив; это может
+// быть и отображенный файл, тогда сортировка идет вне оперативной памяти
+// через page cache. Результат всегда оказывается на месте исходного массива.
+
+// Разряд LSD radix не шире RADIX_MAX_BITS: 2^11 счетчиков на поток
+// помещаются в L1
+#define RADIX_MAX_BITS 11
+
+// LSD radix для int: ключ - value - range.min, поэтому число проходов
+// определяется шириной max - min, а разряды делятся между проходами поровну
+// (20 бит - два прохода по 10). Проход, где все ключи попали в одну
+// корзину, пропускается. Возвращает число выполненных проходов.
+int RadixSort(int *array, int *buffer, size_t size, struct MinMax range,
+              int threads);
+
+// Sample sort для элементов любого размера с компаратором как у qsort:
+// по случайной выборке выбираются threads - 1 разделителей, срезы
+// раскладываются по корзинам, и каждый поток сортирует свою корзину
+void SampleSort(void *base, void *buffer, size_t count, size_t size,
+                int (*compare)(const void *, const void *), int threads);
+
+// Сортировка слиянием: потоки сортируют свои срезы, затем срезы сливаются
+// попарно за log2(threads) раундов. Выход каждого раунда делится между
+// потоками поровну, границы частей внутри слияния ищутся бинарным поиском
+// по диагонали (merge path), так что последнее слияние тоже параллельно.
+void MergeSort(int *array, int *buffer, size_t size, int threads);
+
+#endif
@@ -0,0 +1,384 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <spawn.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "timing.h"
+
+// Задержка порождения воркеров при разном размере памяти родителя. Как в
+// zombie.c, ребенок сразу завершается, а родитель его пожинает; меряются
+// вызов порождения и ожидание для fork, fork + exec, vfork, posix_spawn,
+// clone(CLONE_VM) и pthread_create.
+
+#define MAX_LIST 16
+#define HISTOGRAM_BUCKETS 24
+#define CLONE_STACK_SIZE (64 * 1024)
+
+extern char **environ;
+
+enum Method {
+    METHOD_FORK,
+    METHOD_FORK_EXEC,
+    METHOD_VFORK,
+    METHOD_POSIX_SPAWN,
+    METHOD_CLONE,
+    METHOD_PTHREAD,
+    METHOD_COUNT
+};
+
+static const char *method_names[] = {"fork", "fork_exec", "vfork",
+                                     "posix_spawn", "clone", "pthread"};
+
+// Порожденный процесс или поток: что ждать на этапе reap
+struct Spawned {
+    pid_t pid;
+    pthread_t thread;
+};
+
+// Дочерний процесс для вариантов с exec: этот же файл с --child
+static char *child_argv[] = {"spawn_bench", "--child", NULL};
+
+static int CloneChild(void *arg) {
+    (void)arg;
+    return 0;
+}
+
+static void *ThreadChild(void *arg) {
+    (void)arg;
+    return NULL;
+}
+
+// Порождает одного ребенка; 0 или код ошибки (errno для fork/vfork/clone,
+// результат pthread_create/posix_spawn, которые errno не выставляют)
+static int Spawn(enum Method method, struct Spawned *spawned, char *stack) {
+    switch (method) {
+        case METHOD_FORK:
+            spawned->pid = fork();
+            if (spawned->pid == 0) _exit(0);
+            return spawned->pid == -1 ? errno : 0;
+        case METHOD_FORK_EXEC:
+            spawned->pid = fork();
+            if (spawned->pid == 0) {
+                execv("/proc/self/exe", child_argv);
+                _exit(127);
+            }
+            return spawned->pid == -1 ? errno : 0;
+        case METHOD_VFORK:
+            // Родитель стоит, пока ребенок не завершится или не сделает exec
+            spawned->pid = vfork();
+            if (spawned->pid == 0) _exit(0);
+            return spawned->pid == -1 ? errno : 0;
+        case METHOD_POSIX_SPAWN:
+            return posix_spawn(&spawned->pid, "/proc/self/exe", NULL, NULL,
+                               child_argv, environ);
+        case METHOD_CLONE:
+            // Общее адресное пространство: таблицы страниц не копируются,
+            // но ребенок - отдельный процесс со своим pid
+            spawned->pid = clone(CloneChild, stack + CLONE_STACK_SIZE,
+                                 CLONE_VM | SIGCHLD, NULL);
+            return spawned->pid == -1 ? errno : 0;
+        default:
+            return pthread_create(&spawned->thread, NULL, ThreadChild, NULL);
+    }
+}
+
+static void Reap(enum Method method, struct Spawned *spawned) {
+    if (method == METHOD_PTHREAD) {
+        pthread_join(spawned->thread, NULL);
+    } else {
+        waitpid(spawned->pid, NULL, 0);
+    }
+}
+
+static int CompareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Перцентиль уже отсортированной выборки
+static double Percentile(const double *sorted, size_t count, double p) {
+    size_t index = (size_t)ceil(p / 100.0 * count);
+    if (index > 0) index--;
+    return sorted[index < count ? index : count - 1];
+}
+
+// Гистограмма по степеням двойки в микросекундах
+static void PrintHistogram(const double *samples, size_t count) {
+    unsigned long buckets[HISTOGRAM_BUCKETS] = {0};
+    unsigned long largest = 0;
+    for (size_t i = 0; i < count; i++) {
+        int b = samples[i] < 1 ? 0 : (int)log2(samples[i]) + 1;
+        if (b >= HISTOGRAM_BUCKETS) b = HISTOGRAM_BUCKETS - 1;
+        buckets[b]++;
+        if (buckets[b] > largest) largest = buckets[b];
+    }
+    for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+        if (buckets[b] == 0) continue;
+        char range[32];
+        if (b == 0) {
+            snprintf(range, sizeof(range), "< 1us");
+        } else {
+            snprintf(range, sizeof(range), "%lu-%luus", 1UL << (b - 1), 1UL << b);
+        }
+        int width = (int)(40 * buckets[b] / largest);
+        printf("    %-16s %-40.*s %lu\n", range, width > 0 ? width : 1,
+               "########################################", buckets[b]);
+    }
+}
+
+// Размер вида 64K, 512M, 8G
+static int ParseSize(const char *text, size_t *size) {
+    char *end;
+    double value = strtod(text, &end);
+    size_t unit = 1;
+    if (*end == 'K' || *end == 'k') unit = 1UL << 10;
+    else if (*end == 'M' || *end == 'm') unit = 1UL << 20;
+    else if (*end == 'G' || *end == 'g') unit = 1UL << 30;
+    if (end == text || value < 0 || (unit > 1 && end[1] != '\0') ||
+        (unit == 1 && *end != '\0')) {
+        return -1;
+    }
+    *size = (size_t)(value * unit);
+    return 0;
+}
+
+static void FormatSize(size_t size, char *out, size_t out_size) {
+    if (size >= (1UL << 30) && size % (1UL << 30) == 0) {
+        snprintf(out, out_size, "%zuG", size >> 30);
+    } else if (size >= (1UL << 20) && size % (1UL << 20) == 0) {
+        snprintf(out, out_size, "%zuM", size >> 20);
+    } else {
+        snprintf(out, out_size, "%zuK", size >> 10);
+    }
+}
+
+// Куча родителя: анонимная память, каждая страница тронута, чтобы она
+// попала в RSS и в таблицы страниц
+static char *AllocateHeap(size_t bytes, bool thp) {
+    if (bytes == 0) return NULL;
+    char *heap = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (heap == MAP_FAILED) return MAP_FAILED;
+    madvise(heap, bytes, thp ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+    long page = sysconf(_SC_PAGESIZE);
+    for (size_t i = 0; i < bytes; i += page) heap[i] = (char)i;
+    return heap;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2 && strcmp(argv[1], "--child") == 0) return 0;
+
+    size_t heap_sizes[MAX_LIST];
+    int heap_count = 0;
+    int workers_list[MAX_LIST];
+    int workers_count = 0;
+    bool methods[METHOD_COUNT];
+    for (int m = 0; m < METHOD_COUNT; m++) methods[m] = true;
+    int repeats = 20;
+    bool thp = false;
+    bool csv = false;
+    bool histograms = true;
+
+    static struct option options[] = {
+        {"heap_sizes", required_argument, 0, 0},
+        {"workers", required_argument, 0, 0},
+        {"methods", required_argument, 0, 0},
+        {"repeats", required_argument, 0, 0},
+        {"thp", no_argument, 0, 0},
+        {"csv", no_argument, 0, 0},
+        {"no_histograms", no_argument, 0, 0},
+        {0, 0, 0, 0}
+    };
+
+    int option_index = 0;
+    while (true) {
+        int c = getopt_long(argc, argv, "", options, &option_index);
+        if (c == -1) break;
+
+        switch (c) {
+            case 0:
+                switch (option_index) {
+                    case 0:
+                        heap_count = 0;
+                        for (char *item = strtok(optarg, ","); item != NULL;
+                             item = strtok(NULL, ",")) {
+                            if (heap_count == MAX_LIST ||
+                                ParseSize(item, &heap_sizes[heap_count]) == -1) {
+                                printf("Heap sizes must be up to %d sizes like 1M,512M,8G\n",
+                                       MAX_LIST);
+                                return 1;
+                            }
+                            heap_count++;
+                        }
+                        break;
+                    case 1:
+                        workers_count = 0;
+                        for (char *item = strtok(optarg, ","); item != NULL;
+                             item = strtok(NULL, ",")) {
+                            if (workers_count == MAX_LIST || atoi(item) <= 0) {
+                                printf("Workers must be up to %d positive numbers\n",
+                                       MAX_LIST);
+                                return 1;
+                            }
+                            workers_list[workers_count++] = atoi(item);
+                        }
+                        break;
+                    case 2:
+                        for (int m = 0; m < METHOD_COUNT; m++) methods[m] = false;
+                        for (char *item = strtok(optarg, ","); item != NULL;
+                             item = strtok(NULL, ",")) {
+                            int m = 0;
+                            while (m < METHOD_COUNT && strcmp(item, method_names[m]) != 0) m++;
+                            if (m == METHOD_COUNT) {
+                                printf("Methods must be fork, fork_exec, vfork, posix_spawn, clone or pthread\n");
+                                return 1;
+                            }
+                            methods[m] = true;
+                        }
+                        break;
+                    case 3:
+                        repeats = atoi(optarg);
+                        if (repeats <= 0) {
+                            printf("Repeats must be a positive number\n");
+                            return 1;
+                        }
+                        break;
+                    case 4:
+                        thp = true;
+                        break;
+                    case 5:
+                        csv = true;
+                        histograms = false;
+                        break;
+                    case 6:
+                        histograms = false;
+                        break;
+                }
+                break;
+            case '?':
+                printf("Usage: %s [--heap_sizes 1M,64M,1G,8G] [--workers 1,8] [--methods fork,fork_exec,vfork,posix_spawn,clone,pthread] [--repeats \"num\"] [--thp] [--csv] [--no_histograms]\n",
+                       argv[0]);
+                return 1;
+            default:
+                printf("getopt returned character code 0%o?\n", c);
+        }
+    }
+
+    if (heap_count == 0) {
+        heap_sizes[heap_count++] = 1UL << 20;
+        heap_sizes[heap_count++] = 64UL << 20;
+        heap_sizes[heap_count++] = 1UL << 30;
+    }
+    if (workers_count == 0) {
+        workers_list[workers_count++] = 1;
+        workers_list[workers_count++] = 8;
+    }
+
+    int max_workers = 0;
+    for (int w = 0; w < workers_count; w++) {
+        if (workers_list[w] > max_workers) max_workers = workers_list[w];
+    }
+    struct Spawned *spawned = malloc(max_workers * sizeof(struct Spawned));
+    char *stacks = malloc((size_t)max_workers * CLONE_STACK_SIZE);
+    double *spawn_us = malloc((size_t)max_workers * repeats * sizeof(double));
+    size_t available = (size_t)sysconf(_SC_AVPHYS_PAGES) * sysconf(_SC_PAGESIZE);
+    // Ненулевой код выхода, если хоть один замер не удался
+    int status = 0;
+
+    if (csv) {
+        printf("method,heap_bytes,workers,spawn_p50_us,spawn_p95_us,spawn_p99_us,spawn_max_us,reap_mean_us,spawns_per_sec\n");
+    } else {
+        printf("%-12s %6s %7s %10s %10s %10s %10s %10s %12s\n", "method", "heap",
+               "workers", "p50 us", "p95 us", "p99 us", "max us", "reap us",
+               "spawns/s");
+    }
+
+    for (int h = 0; h < heap_count; h++) {
+        // 20 цифр size_t, суффикс и '\0'
+        char heap_label[24];
+        FormatSize(heap_sizes[h], heap_label, sizeof(heap_label));
+        // Родитель и fork-дети делят страницы, но запас нужен на таблицы
+        if (heap_sizes[h] > available / 10 * 9) {
+            printf("Heap %s skipped: only %zu MB of memory available\n",
+                   heap_label, available >> 20);
+            continue;
+        }
+        char *heap = AllocateHeap(heap_sizes[h], thp);
+        if (heap == MAP_FAILED) {
+            printf("Heap %s skipped: mmap failed\n", heap_label);
+            continue;
+        }
+
+        for (int m = 0; m < METHOD_COUNT; m++) {
+            if (!methods[m]) continue;
+            for (int w = 0; w < workers_count; w++) {
+                int workers = workers_list[w];
+                size_t samples = 0;
+                uint64_t reap_ns = 0, total_ns = 0;
+                int failed = 0;
+                fflush(stdout);
+
+                // Раунд: порождаем всех воркеров подряд, затем пожинаем
+                for (int r = 0; r < repeats && !failed; r++) {
+                    uint64_t round_start = MonotonicNs();
+                    int started = 0;
+                    for (int i = 0; i < workers; i++) {
+                        uint64_t start = MonotonicNs();
+                        failed = Spawn(m, &spawned[i],
+                                       stacks + (size_t)i * CLONE_STACK_SIZE);
+                        if (failed != 0) break;
+                        spawn_us[samples++] = (MonotonicNs() - start) / 1e3;
+                        started++;
+                    }
+                    uint64_t reap_start = MonotonicNs();
+                    for (int i = 0; i < started; i++) Reap(m, &spawned[i]);
+                    uint64_t round_end = MonotonicNs();
+                    reap_ns += round_end - reap_start;
+                    total_ns += round_end - round_start;
+                }
+                if (failed) {
+                    printf("%-12s %6s %7d failed: %s\n", method_names[m],
+                           heap_label, workers, strerror(failed));
+                    status = 1;
+                    continue;
+                }
+
+                qsort(spawn_us, samples, sizeof(double), CompareDoubles);
+                double p50 = Percentile(spawn_us, samples, 50);
+                double p95 = Percentile(spawn_us, samples, 95);
+                double p99 = Percentile(spawn_us, samples, 99);
+                double reap = reap_ns / 1e3 / samples;
+                double rate = samples / (total_ns / 1e9);
+                if (csv) {
+                    printf("%s,%zu,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.1f\n",
+                           method_names[m], heap_sizes[h], workers, p50, p95,
+                           p99, spawn_us[samples - 1], reap, rate);
+                } else {
+                    printf("%-12s %6s %7d %10.1f %10.1f %10.1f %10.1f %10.1f %12.0f\n",
+                           method_names[m], heap_label, workers, p50, p95, p99,
+                           spawn_us[samples - 1], reap, rate);
+                }
+                if (histograms) PrintHistogram(spawn_us, samples);
+            }
+        }
+        if (heap) munmap(heap, heap_sizes[h]);
+    }
+
+    free(spawned);
+    free(stacks);
+    free(spawn_us);
+    return status;
+}
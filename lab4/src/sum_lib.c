@@ -1,9 +1,9 @@
 #include "sum_lib.h"
 #include <pthread.h>
 
-int Sum(const struct SumArgs *args) {
-    int sum = 0;
-    for (int i = args->begin; i < args->end; i++) {
+int64_t Sum(const struct SumArgs *args) {
+    int64_t sum = 0;
+    for (size_t i = args->begin; i < args->end; i++) {
         sum += args->array[i];
     }
     return sum;
@@ -11,5 +11,5 @@ int Sum(const struct SumArgs *args) {
 
 void* ThreadSum(void* args) {
     struct SumArgs *sum_args = (struct SumArgs *)args;
-    return (void *)(size_t)Sum(sum_args);
+    return (void *)(intptr_t)Sum(sum_args);
 }
\ No newline at end of file
@@ -1,15 +1,17 @@
 #ifndef SUM_LIB_H
 #define SUM_LIB_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 struct SumArgs {
     int *array;
-    int begin;
-    int end;
+    size_t begin;
+    size_t end;
 };
 
-int Sum(const struct SumArgs *args);
+// Сумма в 64 битах: сумма int32 переполняет int уже на тысячах элементов
+int64_t Sum(const struct SumArgs *args);
 void* ThreadSum(void* args);
 
 #endif
\ No newline at end of file
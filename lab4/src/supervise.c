@@ -0,0 +1,165 @@
+#include "supervise.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/pidfd.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+
+static int ArmTimer(int epoll_fd, double timeout_sec, uint64_t tag) {
+  int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+  if (timer_fd == -1) return -1;
+
+  struct itimerspec spec = {0};
+  spec.it_value.tv_sec = (time_t)timeout_sec;
+  spec.it_value.tv_nsec =
+      (long)((timeout_sec - (double)spec.it_value.tv_sec) * 1e9);
+  if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+    spec.it_value.tv_nsec = 1;
+
+  struct epoll_event ev = {.events = EPOLLIN, .data.u64 = tag};
+  if (timerfd_settime(timer_fd, 0, &spec, NULL) == -1 ||
+      epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev) == -1) {
+    close(timer_fd);
+    return -1;
+  }
+  return timer_fd;
+}
+
+int OpenSupervisor(struct Supervisor *supervisor, int capacity,
+                   double timeout_sec) {
+  supervisor->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (supervisor->epoll_fd == -1) {
+    perror("epoll_create1 failed");
+    return -1;
+  }
+  supervisor->capacity = capacity;
+  supervisor->pids = calloc(capacity, sizeof(pid_t));
+  supervisor->pidfds = malloc(capacity * sizeof(int));
+  supervisor->running = calloc(capacity, sizeof(bool));
+  for (int i = 0; i < capacity; i++) supervisor->pidfds[i] = -1;
+  supervisor->active = 0;
+  supervisor->timed_out = false;
+
+  // Таймер помечается номером capacity, процессы - своими tag
+  supervisor->timer_fd = -1;
+  if (timeout_sec > 0) {
+    supervisor->timer_fd =
+        ArmTimer(supervisor->epoll_fd, timeout_sec, (uint64_t)capacity);
+    if (supervisor->timer_fd == -1) perror("timerfd failed");
+  }
+  return 0;
+}
+
+void SuperviseChild(struct Supervisor *supervisor, int tag, pid_t pid) {
+  supervisor->pids[tag] = pid;
+  supervisor->running[tag] = true;
+  int pidfd = pidfd_open(pid, 0);
+  struct epoll_event ev = {.events = EPOLLIN, .data.u64 = (uint64_t)tag};
+  if (pidfd == -1 ||
+      epoll_ctl(supervisor->epoll_fd, EPOLL_CTL_ADD, pidfd, &ev) == -1) {
+    perror("pidfd_open failed");
+    // Такой процесс все равно дождемся, но уже блокирующим waitpid
+    if (pidfd != -1) close(pidfd);
+    return;
+  }
+  supervisor->pidfds[tag] = pidfd;
+  supervisor->active++;
+}
+
+// Пожинает завершившийся или убитый процесс
+static bool Reap(struct Supervisor *supervisor, int tag) {
+  int status;
+  bool exited_ok = waitpid(supervisor->pids[tag], &status, 0) ==
+                       supervisor->pids[tag] &&
+                   WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  if (supervisor->pidfds[tag] != -1) {
+    epoll_ctl(supervisor->epoll_fd, EPOLL_CTL_DEL, supervisor->pidfds[tag],
+              NULL);
+    close(supervisor->pidfds[tag]);
+    supervisor->pidfds[tag] = -1;
+    supervisor->active--;
+  }
+  supervisor->running[tag] = false;
+  return exited_ok;
+}
+
+int WaitNextChild(struct Supervisor *supervisor, int wait_ms, bool *exited_ok) {
+  if (supervisor->timed_out) return SUPERVISE_TIMEOUT;
+  if (supervisor->active == 0) return SUPERVISE_DONE;
+
+  // Процесс становится читаемым через pidfd ровно в момент завершения,
+  // поэтому каждый ребенок пожинается сразу, без периодического опроса
+  struct epoll_event event;
+  int n;
+  do {
+    n = epoll_wait(supervisor->epoll_fd, &event, 1, wait_ms);
+  } while (n == -1 && errno == EINTR);
+  if (n == -1) {
+    perror("epoll_wait failed");
+    return SUPERVISE_ERROR;
+  }
+  if (n == 0) return SUPERVISE_IDLE;
+
+  uint64_t tag = event.data.u64;
+  if (tag == (uint64_t)supervisor->capacity) {
+    supervisor->timed_out = true;
+    return SUPERVISE_TIMEOUT;
+  }
+  *exited_ok = Reap(supervisor, (int)tag);
+  return (int)tag;
+}
+
+void KillChild(struct Supervisor *supervisor, int tag) {
+  if (!supervisor->running[tag]) return;
+  kill(supervisor->pids[tag], SIGKILL);
+  Reap(supervisor, tag);
+}
+
+int CloseSupervisor(struct Supervisor *supervisor, bool *finished) {
+  // Добиваем тех, кто не успел, и забираем всех оставшихся
+  int completed = 0;
+  for (int i = 0; i < supervisor->capacity; i++) {
+    if (!supervisor->running[i]) continue;
+    if (supervisor->timed_out) kill(supervisor->pids[i], SIGKILL);
+    if (Reap(supervisor, i) && !supervisor->timed_out) {
+      if (finished) finished[i] = true;
+      completed++;
+    }
+  }
+
+  if (supervisor->timer_fd != -1) close(supervisor->timer_fd);
+  close(supervisor->epoll_fd);
+  free(supervisor->pids);
+  free(supervisor->pidfds);
+  free(supervisor->running);
+  return completed;
+}
+
+int SuperviseChildren(const pid_t *pids, int count, double timeout_sec,
+                      bool *finished, bool *timed_out) {
+  *timed_out = false;
+  if (count <= 0) return 0;
+  for (int i = 0; i < count; i++) finished[i] = false;
+
+  struct Supervisor supervisor;
+  if (OpenSupervisor(&supervisor, count, timeout_sec) == -1) return -1;
+  for (int i = 0; i < count; i++) SuperviseChild(&supervisor, i, pids[i]);
+
+  int completed = 0;
+  while (true) {
+    bool exited_ok;
+    int tag = WaitNextChild(&supervisor, -1, &exited_ok);
+    if (tag < 0) break;
+    finished[tag] = exited_ok;
+    if (exited_ok) completed++;
+  }
+  *timed_out = supervisor.timed_out;
+  return completed + CloseSupervisor(&supervisor, finished);
+}
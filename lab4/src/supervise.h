@@ -0,0 +1,49 @@
+#ifndef SUPERVISE_H
+#define SUPERVISE_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+// Наблюдение за дочерними процессами через epoll по их pidfd и общий
+// таймаут (timerfd). Процессы можно добавлять по ходу, каждый под своим
+// номером tag < capacity.
+struct Supervisor {
+  int epoll_fd;
+  int timer_fd;
+  int capacity;
+  pid_t *pids;
+  // -1 - pidfd открыть не удалось, такой процесс ждется в CloseSupervisor
+  int *pidfds;
+  bool *running;
+  int active;
+  bool timed_out;
+};
+
+// Что вернул WaitNextChild, кроме номера завершившегося процесса
+#define SUPERVISE_IDLE -1     // за wait_ms ничего не завершилось
+#define SUPERVISE_TIMEOUT -2  // истек общий таймаут
+#define SUPERVISE_DONE -3     // ждать больше некого
+#define SUPERVISE_ERROR -4
+
+// timeout_sec <= 0 - без общего таймаута; 0 или -1
+int OpenSupervisor(struct Supervisor *supervisor, int capacity,
+                   double timeout_sec);
+void SuperviseChild(struct Supervisor *supervisor, int tag, pid_t pid);
+// Ждет завершения одного процесса не дольше wait_ms (-1 - без
+// ограничения) и пожинает его; *exited_ok - процесс завершился сам с кодом 0
+int WaitNextChild(struct Supervisor *supervisor, int wait_ms, bool *exited_ok);
+// SIGKILL и ожидание процесса, если он еще работает
+void KillChild(struct Supervisor *supervisor, int tag);
+// После таймаута оставшиеся процессы убиваются, иначе их дожидаются.
+// Возвращает число процессов из оставшихся, завершившихся самостоятельно.
+int CloseSupervisor(struct Supervisor *supervisor, bool *finished);
+
+// Ждет завершения count дочерних процессов через epoll по их pidfd.
+// Если timeout_sec > 0, через timeout_sec секунд (таймер timerfd) оставшиеся
+// процессы получают SIGKILL и *timed_out выставляется в true.
+// finished[i] == true для процессов, которые завершились сами.
+// Возвращает число завершившихся самостоятельно процессов или -1 при ошибке.
+int SuperviseChildren(const pid_t *pids, int count, double timeout_sec,
+                      bool *finished, bool *timed_out);
+
+#endif
@@ -0,0 +1,302 @@
+#define _GNU_SOURCE
+#include "topology.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Из <numaif.h>, чтобы не зависеть от libnuma
+#define TOPOLOGY_MPOL_PREFERRED 1
+#define TOPOLOGY_MAX_NODES 1024
+
+static int ReadSysfsInt(const char *path, int fallback) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) return fallback;
+  int value;
+  if (fscanf(file, "%d", &value) != 1) value = fallback;
+  fclose(file);
+  return value;
+}
+
+// Разбирает список вида "0-3,8-11" и проставляет node всем CPU из него
+static void AssignNode(struct Topology *topology, const char *list, int node) {
+  const char *p = list;
+  while (*p) {
+    char *next;
+    long first = strtol(p, &next, 10);
+    if (next == p) break;
+    long last = first;
+    if (*next == '-') {
+      p = next + 1;
+      last = strtol(p, &next, 10);
+    }
+    for (int i = 0; i < topology->cpu_count; i++) {
+      int cpu = topology->cpus[i].cpu;
+      if (cpu >= first && cpu <= last) topology->cpus[i].node = node;
+    }
+    p = *next == ',' ? next + 1 : next;
+    if (*p == '\n') break;
+  }
+}
+
+int LoadTopology(struct Topology *topology) {
+  cpu_set_t allowed;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) == -1) return -1;
+
+  topology->cpu_count = CPU_COUNT(&allowed);
+  topology->cpus = malloc(topology->cpu_count * sizeof(struct CpuInfo));
+  if (topology->cpus == NULL) return -1;
+
+  char path[128];
+  int n = 0;
+  for (int cpu = 0; cpu < CPU_SETSIZE && n < topology->cpu_count; cpu++) {
+    if (!CPU_ISSET(cpu, &allowed)) continue;
+    struct CpuInfo *info = &topology->cpus[n++];
+    info->cpu = cpu;
+    snprintf(path, sizeof(path),
+             "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+    info->package = ReadSysfsInt(path, 0);
+    snprintf(path, sizeof(path),
+             "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+    info->core = ReadSysfsInt(path, cpu);
+    info->node = 0;
+  }
+
+  // Узлы без sysfs (или без NUMA) сводятся к одному узлу 0
+  topology->node_count = 1;
+  char list[4096];
+  for (int node = 0; node < TOPOLOGY_MAX_NODES; node++) {
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+             node);
+    FILE *file = fopen(path, "r");
+    if (file == NULL) continue;
+    if (fgets(list, sizeof(list), file) != NULL) {
+      AssignNode(topology, list, node);
+      if (node + 1 > topology->node_count) topology->node_count = node + 1;
+    }
+    fclose(file);
+  }
+
+  // CPU идут по возрастанию, поэтому номер SMT-соседа - это число уже
+  // встреченных CPU того же физического ядра
+  for (int i = 0; i < topology->cpu_count; i++) {
+    topology->cpus[i].sibling = 0;
+    for (int j = 0; j < i; j++) {
+      if (topology->cpus[j].package == topology->cpus[i].package &&
+          topology->cpus[j].core == topology->cpus[i].core) {
+        topology->cpus[i].sibling++;
+      }
+    }
+  }
+  return 0;
+}
+
+void FreeTopology(struct Topology *topology) {
+  free(topology->cpus);
+  topology->cpus = NULL;
+  topology->cpu_count = 0;
+}
+
+static const char *policy_names[] = {"none", "compact", "scatter", "smt-avoid"};
+
+int ParsePinPolicy(const char *name, enum PinPolicy *policy) {
+  for (int i = 0; i < (int)(sizeof(policy_names) / sizeof(policy_names[0]));
+       i++) {
+    if (strcmp(name, policy_names[i]) == 0) {
+      *policy = (enum PinPolicy)i;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+const char *PinPolicyName(enum PinPolicy policy) {
+  return policy_names[policy];
+}
+
+// Ключ сортировки CPU для политики: чем меньше, тем раньше CPU получит воркера
+struct PlacementKey {
+  int key[4];
+  int cpu;
+};
+
+static int ComparePlacement(const void *a, const void *b) {
+  const struct PlacementKey *x = a, *y = b;
+  for (int i = 0; i < 4; i++) {
+    if (x->key[i] != y->key[i]) return x->key[i] < y->key[i] ? -1 : 1;
+  }
+  return x->cpu - y->cpu;
+}
+
+// Порядковый номер физического ядра CPU i внутри его узла. Первый SMT-сосед
+// ядра всегда идет раньше остальных, поэтому ядра считаем по ним.
+static int CoreRank(const struct Topology *topology, int i) {
+  const struct CpuInfo *info = &topology->cpus[i];
+  int rank = 0;
+  for (int j = 0; j < topology->cpu_count; j++) {
+    const struct CpuInfo *other = &topology->cpus[j];
+    if (other->sibling != 0 || other->node != info->node) continue;
+    if (other->package == info->package && other->core == info->core) break;
+    rank++;
+  }
+  return rank;
+}
+
+void PlanPlacement(const struct Topology *topology, enum PinPolicy policy,
+                   int workers, int *cpus) {
+  int count = topology->cpu_count;
+  struct PlacementKey *keys = malloc(count * sizeof(struct PlacementKey));
+  for (int i = 0; i < count; i++) {
+    const struct CpuInfo *info = &topology->cpus[i];
+    struct PlacementKey *k = &keys[i];
+    k->cpu = info->cpu;
+    switch (policy) {
+      case PIN_SCATTER:
+        k->key[0] = info->sibling;
+        k->key[1] = CoreRank(topology, i);
+        k->key[2] = info->node;
+        k->key[3] = info->package;
+        break;
+      case PIN_SMT_AVOID:
+        k->key[0] = info->sibling;
+        k->key[1] = info->node;
+        k->key[2] = info->package;
+        k->key[3] = info->core;
+        break;
+      default:
+        k->key[0] = info->node;
+        k->key[1] = info->package;
+        k->key[2] = info->core;
+        k->key[3] = info->sibling;
+    }
+  }
+  qsort(keys, count, sizeof(struct PlacementKey), ComparePlacement);
+  for (int w = 0; w < workers; w++) cpus[w] = keys[w % count].cpu;
+  free(keys);
+}
+
+int NodeOfCpu(const struct Topology *topology, int cpu) {
+  for (int i = 0; i < topology->cpu_count; i++) {
+    if (topology->cpus[i].cpu == cpu) return topology->cpus[i].node;
+  }
+  return 0;
+}
+
+int PinToCpu(int cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  // pid 0 - вызывающий поток, а не весь процесс
+  return sched_setaffinity(0, sizeof(set), &set);
+}
+
+int BindToNode(void *addr, size_t length, int node) {
+  if (node < 0 || node >= TOPOLOGY_MAX_NODES) return -1;
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t first = ((size_t)addr + page - 1) & ~(page - 1);
+  size_t last = ((size_t)addr + length) & ~(page - 1);
+  if (last <= first) return 0;
+
+  unsigned long mask[TOPOLOGY_MAX_NODES / (8 * sizeof(unsigned long))] = {0};
+  mask[node / (8 * sizeof(unsigned long))] |=
+      1ul << (node % (8 * sizeof(unsigned long)));
+  return (int)syscall(SYS_mbind, (void *)first, last - first,
+                      TOPOLOGY_MPOL_PREFERRED, mask, TOPOLOGY_MAX_NODES, 0);
+}
+
+struct PinnedArgs {
+  const struct Topology *topology;
+  int cpu;
+  char *base;
+  size_t bytes_per_item;
+  RangeFn fn;
+  void *ctx;
+  size_t begin;
+  size_t end;
+};
+
+static void *PinnedThread(void *args) {
+  struct PinnedArgs *range = (struct PinnedArgs *)args;
+  PinToCpu(range->cpu);
+  if (range->base != NULL) {
+    BindToNode(range->base + range->begin * range->bytes_per_item,
+               (range->end - range->begin) * range->bytes_per_item,
+               NodeOfCpu(range->topology, range->cpu));
+  }
+  range->fn(range->ctx, range->begin, range->end);
+  return NULL;
+}
+
+void PinnedFor(const struct Topology *topology, const int *cpus,
+               int threads_num, size_t count, void *base,
+               size_t bytes_per_item, RangeFn fn, void *ctx) {
+  pthread_t *threads = malloc(threads_num * sizeof(pthread_t));
+  bool *started = malloc(threads_num * sizeof(bool));
+  struct PinnedArgs *args = malloc(threads_num * sizeof(struct PinnedArgs));
+  size_t segment = count / threads_num;
+  for (int t = 0; t < threads_num; t++) {
+    args[t].topology = topology;
+    args[t].cpu = cpus[t];
+    args[t].base = base;
+    args[t].bytes_per_item = bytes_per_item;
+    args[t].fn = fn;
+    args[t].ctx = ctx;
+    args[t].begin = t * segment;
+    args[t].end = (t == threads_num - 1) ? count : (t + 1) * segment;
+  }
+  // Здесь вызывающий поток ничего не считает: его нельзя перепривязывать
+  for (int t = 0; t < threads_num; t++) {
+    started[t] = pthread_create(&threads[t], NULL, PinnedThread, &args[t]) == 0;
+    if (!started[t]) args[t].fn(args[t].ctx, args[t].begin, args[t].end);
+  }
+  for (int t = 0; t < threads_num; t++) {
+    if (started[t]) pthread_join(threads[t], NULL);
+  }
+
+  free(threads);
+  free(started);
+  free(args);
+}
+
+struct GenerateTask {
+  int *array;
+  unsigned int seed;
+};
+
+static void GenerateSegment(void *ctx, size_t begin, size_t end) {
+  struct GenerateTask *task = (struct GenerateTask *)ctx;
+  GenerateArrayRange(task->array + begin, begin, end - begin, task->seed);
+}
+
+void GeneratePlaced(const struct Topology *topology, const int *cpus,
+                    int workers, int *array, size_t size,
+                    unsigned int seed) {
+  struct GenerateTask task = {array, seed};
+  PinnedFor(topology, cpus, workers, size, array, sizeof(int), GenerateSegment,
+            &task);
+}
+
+void PrintNodeBandwidth(const struct Topology *topology, const int *cpus,
+                        int workers, const unsigned long *elements,
+                        const double *busy_ms, size_t element_size) {
+  for (int node = 0; node < topology->node_count; node++) {
+    int node_workers = 0;
+    unsigned long node_elements = 0;
+    double node_ms = 0;
+    for (int w = 0; w < workers; w++) {
+      if (NodeOfCpu(topology, cpus[w]) != node) continue;
+      node_workers++;
+      node_elements += elements[w];
+      if (busy_ms[w] > node_ms) node_ms = busy_ms[w];
+    }
+    if (node_workers == 0) continue;
+    double gbps = node_ms > 0 ? node_elements * element_size / node_ms / 1e6 : 0;
+    printf("Node %d: %d workers, %lu elements, %.3fms, %.2f GB/s\n", node,
+           node_workers, node_elements, node_ms, gbps);
+  }
+}
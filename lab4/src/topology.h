@@ -0,0 +1,67 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <stddef.h>
+
+#include "utils.h"
+
+// Политика размещения воркеров по CPU:
+// compact - соседние воркеры на SMT-соседях и ядрах одного сокета,
+// scatter - воркеры по кругу между NUMA-узлами,
+// smt-avoid - сначала по одному воркеру на физическое ядро.
+enum PinPolicy { PIN_NONE, PIN_COMPACT, PIN_SCATTER, PIN_SMT_AVOID };
+
+struct CpuInfo {
+  int cpu;
+  int package;
+  int core;
+  int node;
+  // Номер среди SMT-соседей одного физического ядра (0 - первый)
+  int sibling;
+};
+
+// Разрешенные процессу CPU с их сокетом, ядром и NUMA-узлом из sysfs
+struct Topology {
+  int cpu_count;
+  struct CpuInfo *cpus;
+  int node_count;
+};
+
+int LoadTopology(struct Topology *topology);
+void FreeTopology(struct Topology *topology);
+
+int ParsePinPolicy(const char *name, enum PinPolicy *policy);
+const char *PinPolicyName(enum PinPolicy policy);
+
+// cpus[i] - CPU для i-го воркера; воркеров больше, чем CPU, - по кругу
+void PlanPlacement(const struct Topology *topology, enum PinPolicy policy,
+                   int workers, int *cpus);
+int NodeOfCpu(const struct Topology *topology, int cpu);
+
+// Привязывает вызывающий поток к одному CPU
+int PinToCpu(int cpu);
+
+// Просит ядро размещать страницы [addr, addr + length) на узле node
+// (mbind с MPOL_PREFERRED); частичные страницы по краям не трогаются
+int BindToNode(void *addr, size_t length, int node);
+
+// Как ParallelFor, но кусок t считает поток, привязанный к cpus[t], и
+// перед этим привязывает свою часть bytes_per_item-элементов base к узлу
+// этого CPU. Страницы, заполненные так, лежат рядом с воркером (first touch).
+void PinnedFor(const struct Topology *topology, const int *cpus,
+               int threads_num, size_t count, void *base,
+               size_t bytes_per_item, RangeFn fn, void *ctx);
+
+// GenerateArray для еще не тронутой памяти: сегмент i-го из workers
+// воркеров заполняется на cpus[i] и попадает на его узел
+void GeneratePlaced(const struct Topology *topology, const int *cpus,
+                    int workers, int *array, size_t size,
+                    unsigned int seed);
+
+// Разбивка пропускной способности по узлам: на каждом узле элементы его
+// воркеров делятся на самое долгое время воркера этого узла
+void PrintNodeBandwidth(const struct Topology *topology, const int *cpus,
+                        int workers, const unsigned long *elements,
+                        const double *busy_ms, size_t element_size);
+
+#endif
@@ -0,0 +1,243 @@
+#include "typed_min_max.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "find_min_max.h"
+#include "utils.h"
+
+// Аккумуляторов по числу элементов в строке кэша: внутренний цикл
+// фиксированной длины векторизуется даже на -O2, и цепочки min/max разных
+// позиций не зависят друг от друга
+#define MIN_MAX_LINE 64
+#define GENERATE_BLOCK 4096
+#define GENERATE_GRAIN (1u << 18)
+
+static const char *type_names[] = {"int8", "int16", "int32",
+                                   "int64", "float", "double"};
+static const size_t type_sizes[] = {1, 2, 4, 8, 4, 8};
+static const enum ElementType type_elements[] = {
+    ELEMENT_INT8,  ELEMENT_INT16, ELEMENT_INT32,
+    ELEMENT_INT64, ELEMENT_FLOAT, ELEMENT_DOUBLE};
+
+int ParseValueType(const char *name, enum ValueType *type) {
+  for (int t = VALUE_INT8; t <= VALUE_DOUBLE; t++) {
+    if (strcmp(name, type_names[t]) == 0) {
+      *type = (enum ValueType)t;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+const char *ValueTypeName(enum ValueType type) { return type_names[type]; }
+
+size_t ValueTypeSize(enum ValueType type) { return type_sizes[type]; }
+
+enum ElementType ValueTypeElement(enum ValueType type) {
+  return type_elements[type];
+}
+
+bool IsFloatType(enum ValueType type) {
+  return type == VALUE_FLOAT || type == VALUE_DOUBLE;
+}
+
+struct TypedMinMax EmptyTypedMinMax(enum ValueType type) {
+  struct TypedMinMax result = {type, {0}, {0}, 0};
+  if (IsFloatType(type)) {
+    result.min.f = INFINITY;
+    result.max.f = -INFINITY;
+  } else {
+    result.min.i = INT64_MAX;
+    result.max.i = INT64_MIN;
+  }
+  return result;
+}
+
+void MergeTypedMinMax(struct TypedMinMax *acc, const struct TypedMinMax *part) {
+  if (IsFloatType(acc->type)) {
+    if (part->min.f < acc->min.f) acc->min.f = part->min.f;
+    if (part->max.f > acc->max.f) acc->max.f = part->max.f;
+  } else {
+    if (part->min.i < acc->min.i) acc->min.i = part->min.i;
+    if (part->max.i > acc->max.i) acc->max.i = part->max.i;
+  }
+  acc->nan_count += part->nan_count;
+}
+
+// Целые: сравнения без ветвлений (pmin/pmax или cmov); хвост короче строки
+// кэша досчитывается в нулевой аккумулятор
+#define DEFINE_INT_MIN_MAX(Name, T, TYPE, LO, HI)                            \
+  struct TypedMinMax GetMinMax##Name(const T *array, size_t begin,           \
+                                     size_t end) {                           \
+    enum { LANES = MIN_MAX_LINE / sizeof(T) };                               \
+    T vmin[LANES], vmax[LANES];                                              \
+    for (int j = 0; j < LANES; j++) {                                        \
+      vmin[j] = HI;                                                          \
+      vmax[j] = LO;                                                          \
+    }                                                                        \
+    size_t i = begin;                                                        \
+    for (; i < end && end - i >= LANES; i += LANES) {                        \
+      for (int j = 0; j < LANES; j++) {                                      \
+        T v = array[i + j];                                                  \
+        vmin[j] = v < vmin[j] ? v : vmin[j];                                 \
+        vmax[j] = v > vmax[j] ? v : vmax[j];                                 \
+      }                                                                      \
+    }                                                                        \
+    for (; i < end; i++) {                                                   \
+      vmin[0] = array[i] < vmin[0] ? array[i] : vmin[0];                     \
+      vmax[0] = array[i] > vmax[0] ? array[i] : vmax[0];                     \
+    }                                                                        \
+    struct TypedMinMax result = EmptyTypedMinMax(TYPE);                      \
+    if (begin >= end) return result;                                         \
+    T min = vmin[0], max = vmax[0];                                          \
+    for (int j = 1; j < LANES; j++) {                                        \
+      min = vmin[j] < min ? vmin[j] : min;                                   \
+      max = vmax[j] > max ? vmax[j] : max;                                   \
+    }                                                                        \
+    result.min.i = min;                                                      \
+    result.max.i = max;                                                      \
+    return result;                                                           \
+  }
+
+// Вещественные: сравнение с NaN ложно, так что NaN не меняет аккумулятор
+// (ровно семантика minps/maxps), а сам NaN учитывается счетчиком той же
+// ширины, что и элемент
+#define DEFINE_FLOAT_MIN_MAX(Name, T, TYPE, NanT)                            \
+  struct TypedMinMax GetMinMax##Name(const T *array, size_t begin,           \
+                                     size_t end) {                           \
+    enum { LANES = MIN_MAX_LINE / sizeof(T) };                               \
+    T vmin[LANES], vmax[LANES];                                              \
+    NanT nans[LANES];                                                        \
+    for (int j = 0; j < LANES; j++) {                                        \
+      vmin[j] = INFINITY;                                                    \
+      vmax[j] = -INFINITY;                                                   \
+      nans[j] = 0;                                                           \
+    }                                                                        \
+    uint64_t nan_count = 0;                                                  \
+    size_t i = begin;                                                        \
+    for (; i < end && end - i >= LANES; i += LANES) {                        \
+      for (int j = 0; j < LANES; j++) {                                      \
+        T v = array[i + j];                                                  \
+        vmin[j] = v < vmin[j] ? v : vmin[j];                                 \
+        vmax[j] = v > vmax[j] ? v : vmax[j];                                 \
+        nans[j] += v != v;                                                   \
+      }                                                                      \
+    }                                                                        \
+    for (; i < end; i++) {                                                   \
+      vmin[0] = array[i] < vmin[0] ? array[i] : vmin[0];                     \
+      vmax[0] = array[i] > vmax[0] ? array[i] : vmax[0];                     \
+      nan_count += array[i] != array[i];                                     \
+    }                                                                        \
+    struct TypedMinMax result = EmptyTypedMinMax(TYPE);                      \
+    T min = vmin[0], max = vmax[0];                                          \
+    for (int j = 0; j < LANES; j++) {                                        \
+      min = vmin[j] < min ? vmin[j] : min;                                   \
+      max = vmax[j] > max ? vmax[j] : max;                                   \
+      nan_count += nans[j];                                                  \
+    }                                                                        \
+    result.min.f = min;                                                      \
+    result.max.f = max;                                                      \
+    result.nan_count = nan_count;                                            \
+    return result;                                                           \
+  }
+
+DEFINE_INT_MIN_MAX(Int8, int8_t, VALUE_INT8, INT8_MIN, INT8_MAX)
+DEFINE_INT_MIN_MAX(Int16, int16_t, VALUE_INT16, INT16_MIN, INT16_MAX)
+DEFINE_INT_MIN_MAX(Int64, int64_t, VALUE_INT64, INT64_MIN, INT64_MAX)
+DEFINE_FLOAT_MIN_MAX(Float, float, VALUE_FLOAT, uint32_t)
+DEFINE_FLOAT_MIN_MAX(Double, double, VALUE_DOUBLE, uint64_t)
+
+// int32 - уже выбранное при старте SIMD-ядро
+struct TypedMinMax GetMinMaxInt32(const int32_t *array, size_t begin,
+                                  size_t end) {
+  struct TypedMinMax result = EmptyTypedMinMax(VALUE_INT32);
+  if (begin >= end) return result;
+  struct MinMax min_max = GetMinMax((int *)array, begin, end);
+  result.min.i = min_max.min;
+  result.max.i = min_max.max;
+  return result;
+}
+
+struct TypedMinMax GetMinMaxTyped(enum ValueType type, const void *array,
+                                  size_t begin, size_t end) {
+  switch (type) {
+    case VALUE_INT8: return GetMinMaxInt8(array, begin, end);
+    case VALUE_INT16: return GetMinMaxInt16(array, begin, end);
+    case VALUE_INT32: return GetMinMaxInt32(array, begin, end);
+    case VALUE_INT64: return GetMinMaxInt64(array, begin, end);
+    case VALUE_FLOAT: return GetMinMaxFloat(array, begin, end);
+    default: return GetMinMaxDouble(array, begin, end);
+  }
+}
+
+void FormatTypedValue(enum ValueType type, union TypedValue value, char *out,
+                      size_t size) {
+  if (IsFloatType(type)) {
+    snprintf(out, size, "%.*g", type == VALUE_FLOAT ? FLT_DIG : DBL_DIG,
+             value.f);
+  } else {
+    snprintf(out, size, "%lld", (long long)value.i);
+  }
+}
+
+void GenerateTypedRange(enum ValueType type, void *array, size_t first,
+                        size_t count, unsigned int seed) {
+  if (type == VALUE_INT32) {
+    GenerateArrayRange(array, first, count, seed);
+    return;
+  }
+  // Широким типам нужно по два элемента исходной последовательности
+  size_t per_value = ValueTypeSize(type) == 8 ? 2 : 1;
+  int block[GENERATE_BLOCK];
+  size_t step = GENERATE_BLOCK / per_value;
+  for (size_t done = 0; done < count; done += step) {
+    size_t part = count - done < step ? count - done : step;
+    GenerateArrayRange(block, (first + done) * per_value, part * per_value,
+                       seed);
+    for (size_t k = 0; k < part; k++) {
+      // Исходные значения неотрицательны (31 бит)
+      uint32_t a = (uint32_t)block[k * per_value];
+      uint32_t b = (uint32_t)block[k * per_value + per_value - 1];
+      size_t index = done + k;
+      switch (type) {
+        case VALUE_INT8:
+          ((int8_t *)array)[index] = (int8_t)a;
+          break;
+        case VALUE_INT16:
+          ((int16_t *)array)[index] = (int16_t)a;
+          break;
+        case VALUE_INT64:
+          ((int64_t *)array)[index] =
+              (int64_t)(((uint64_t)a << 33) | ((uint64_t)b << 2) | (a & 3));
+          break;
+        case VALUE_FLOAT:
+          ((float *)array)[index] = (float)((a - 1073741824.0) / 1024.0);
+          break;
+        default:
+          ((double *)array)[index] = (a - 1073741824.0) + b / 2147483648.0;
+          break;
+      }
+    }
+  }
+}
+
+struct GenerateTypedArgs {
+  enum ValueType type;
+  char *array;
+  unsigned int seed;
+};
+
+static void GenerateTypedSlice(void *ctx, size_t begin, size_t end) {
+  struct GenerateTypedArgs *gen = (struct GenerateTypedArgs *)ctx;
+  GenerateTypedRange(gen->type, gen->array + begin * ValueTypeSize(gen->type),
+                     begin, end - begin, gen->seed);
+}
+
+void GenerateTypedArray(enum ValueType type, void *array, size_t count,
+                        unsigned int seed) {
+  struct GenerateTypedArgs gen = {type, array, seed};
+  ParallelFor(count, GENERATE_GRAIN, 0, GenerateTypedSlice, &gen);
+}
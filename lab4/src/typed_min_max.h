@@ -0,0 +1,93 @@
+#ifndef TYPED_MIN_MAX_H
+#define TYPED_MIN_MAX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dataset.h"
+
+// Тип элементов массива для min/max; int32 считается SIMD-ядром GetMinMax
+enum ValueType {
+  VALUE_INT8,
+  VALUE_INT16,
+  VALUE_INT32,
+  VALUE_INT64,
+  VALUE_FLOAT,
+  VALUE_DOUBLE
+};
+
+// Результат для любого типа: целые в i, вещественные в f. Для пустого
+// среза (или если все элементы NaN) min > max. NaN в min/max не попадают,
+// а считаются отдельно в nan_count.
+union TypedValue {
+  int64_t i;
+  double f;
+};
+
+struct TypedMinMax {
+  enum ValueType type;
+  union TypedValue min;
+  union TypedValue max;
+  uint64_t nan_count;
+};
+
+int ParseValueType(const char *name, enum ValueType *type);
+const char *ValueTypeName(enum ValueType type);
+size_t ValueTypeSize(enum ValueType type);
+bool IsFloatType(enum ValueType type);
+// Тип элементов в заголовке файла набора данных
+enum ElementType ValueTypeElement(enum ValueType type);
+
+// Ядра по типам: без ветвлений, по независимому аккумулятору на каждый
+// элемент строки кэша, так что цикл векторизуется и узкие типы дают
+// больше элементов за такт
+struct TypedMinMax GetMinMaxInt8(const int8_t *array, size_t begin, size_t end);
+struct TypedMinMax GetMinMaxInt16(const int16_t *array, size_t begin,
+                                  size_t end);
+struct TypedMinMax GetMinMaxInt32(const int32_t *array, size_t begin,
+                                  size_t end);
+struct TypedMinMax GetMinMaxInt64(const int64_t *array, size_t begin,
+                                  size_t end);
+struct TypedMinMax GetMinMaxFloat(const float *array, size_t begin, size_t end);
+struct TypedMinMax GetMinMaxDouble(const double *array, size_t begin,
+                                   size_t end);
+
+// Ядро по типу указателя на этапе компиляции
+#define GetMinMaxOf(array, begin, end)       \
+  _Generic((array),                          \
+      int8_t *: GetMinMaxInt8,               \
+      const int8_t *: GetMinMaxInt8,         \
+      int16_t *: GetMinMaxInt16,             \
+      const int16_t *: GetMinMaxInt16,       \
+      int32_t *: GetMinMaxInt32,             \
+      const int32_t *: GetMinMaxInt32,       \
+      int64_t *: GetMinMaxInt64,             \
+      const int64_t *: GetMinMaxInt64,       \
+      float *: GetMinMaxFloat,               \
+      const float *: GetMinMaxFloat,         \
+      double *: GetMinMaxDouble,             \
+      const double *: GetMinMaxDouble)(array, begin, end)
+
+// Ядро по типу, известному только при выполнении (--type)
+struct TypedMinMax GetMinMaxTyped(enum ValueType type, const void *array,
+                                  size_t begin, size_t end);
+// Пустой результат, нейтральный для MergeTypedMinMax
+struct TypedMinMax EmptyTypedMinMax(enum ValueType type);
+void MergeTypedMinMax(struct TypedMinMax *acc, const struct TypedMinMax *part);
+
+// Значение в буфер: целое или вещественное с %g
+void FormatTypedValue(enum ValueType type, union TypedValue value, char *out,
+                      size_t size);
+
+// Заполняет array[0, count) элементами [first, first + count) типа type
+// из той же последовательности, что и GenerateArray: int32 совпадает с
+// ней, узкие типы - ее младшие биты, int64 и вещественные получают
+// значения со знаком из двух соседних элементов
+void GenerateTypedRange(enum ValueType type, void *array, size_t first,
+                        size_t count, unsigned int seed);
+// Параллельно, как GenerateArray
+void GenerateTypedArray(enum ValueType type, void *array, size_t count,
+                        unsigned int seed);
+
+#endif
@@ -1,10 +1,268 @@
 #include "utils.h"
 
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
-void GenerateArray(int *array, unsigned int array_size, unsigned int seed) {
-  srand(seed);
-  for (int i = 0; i < array_size; i++) {
-    array[i] = rand();
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define UTILS_X86 1
+#endif
+
+// Меньше этого размера массив заполняется в одном потоке
+#define PARALLEL_GENERATE_THRESHOLD (1u << 18)
+
+#define HUGE_PAGE_SIZE (2ul << 20)
+
+// Счетчиковый генератор: i-й элемент зависит только от (seed, i), поэтому
+// любой поток или процесс может заполнить свой кусок независимо, и массив
+// получается одинаковым при любом разбиении. Перемешивание - lowbias32.
+static inline uint32_t Mix32(uint32_t x) {
+  x ^= x >> 16;
+  x *= 0x7feb352du;
+  x ^= x >> 15;
+  x *= 0x846ca68bu;
+  x ^= x >> 16;
+  return x;
+}
+
+struct GeneratorKey {
+  uint32_t k0;
+  uint32_t k1;
+};
+
+static struct GeneratorKey MakeKey(unsigned int seed) {
+  // splitmix64 разносит близкие seed по всему пространству ключей
+  uint64_t z = (uint64_t)seed + 0x9e3779b97f4a7c15ull;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  z ^= z >> 31;
+  struct GeneratorKey key = {(uint32_t)z, (uint32_t)(z >> 32)};
+  return key;
+}
+
+// Каждые 2^32 элементов ключ сдвигается, чтобы последовательность не
+// повторялась; для первых 2^32 элементов ключ исходный
+static struct GeneratorKey KeyForBlock(struct GeneratorKey key, uint32_t block) {
+  key.k1 += block * 0x9e3779b9u;
+  return key;
+}
+
+// Значения в том же диапазоне, что и у rand(): [0, 2^31 - 1]
+static inline int GenerateValue(struct GeneratorKey key, uint32_t index) {
+  return (int)(Mix32(Mix32(index ^ key.k0) + key.k1) >> 1);
+}
+
+typedef void (*FillKernel)(int *array, uint32_t first, uint32_t count,
+                           struct GeneratorKey key);
+
+static void FillScalar(int *array, uint32_t first, uint32_t count,
+                       struct GeneratorKey key) {
+  for (uint32_t i = 0; i < count; i++) {
+    array[i] = GenerateValue(key, first + i);
+  }
+}
+
+#ifdef UTILS_X86
+
+__attribute__((target("avx2")))
+static inline __m256i Mix32Avx2(__m256i x) {
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+  x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7feb352d));
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+  x = _mm256_mullo_epi32(x, _mm256_set1_epi32((int)0x846ca68bu));
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+  return x;
+}
+
+__attribute__((target("avx2")))
+static void FillAvx2(int *array, uint32_t first, uint32_t count,
+                     struct GeneratorKey key) {
+  const __m256i k0 = _mm256_set1_epi32((int)key.k0);
+  const __m256i k1 = _mm256_set1_epi32((int)key.k1);
+  const __m256i step = _mm256_set1_epi32(8);
+  __m256i index = _mm256_add_epi32(_mm256_set1_epi32((int)first),
+                                   _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+
+  uint32_t i = 0;
+  for (; count - i >= 8; i += 8) {
+    __m256i x = Mix32Avx2(_mm256_xor_si256(index, k0));
+    x = Mix32Avx2(_mm256_add_epi32(x, k1));
+    _mm256_storeu_si256((__m256i *)(array + i), _mm256_srli_epi32(x, 1));
+    index = _mm256_add_epi32(index, step);
+  }
+  FillScalar(array + i, first + i, count - i, key);
+}
+
+__attribute__((target("avx512f")))
+static inline __m512i Mix32Avx512(__m512i x) {
+  x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 16));
+  x = _mm512_mullo_epi32(x, _mm512_set1_epi32(0x7feb352d));
+  x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 15));
+  x = _mm512_mullo_epi32(x, _mm512_set1_epi32((int)0x846ca68bu));
+  x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 16));
+  return x;
+}
+
+__attribute__((target("avx512f")))
+static void FillAvx512(int *array, uint32_t first, uint32_t count,
+                       struct GeneratorKey key) {
+  const __m512i k0 = _mm512_set1_epi32((int)key.k0);
+  const __m512i k1 = _mm512_set1_epi32((int)key.k1);
+  const __m512i step = _mm512_set1_epi32(16);
+  __m512i index = _mm512_add_epi32(
+      _mm512_set1_epi32((int)first),
+      _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+
+  uint32_t i = 0;
+  for (; count - i >= 16; i += 16) {
+    __m512i x = Mix32Avx512(_mm512_xor_si512(index, k0));
+    x = Mix32Avx512(_mm512_add_epi32(x, k1));
+    _mm512_storeu_si512((void *)(array + i), _mm512_srli_epi32(x, 1));
+    index = _mm512_add_epi32(index, step);
+  }
+  FillScalar(array + i, first + i, count - i, key);
+}
+
+#endif
+
+static FillKernel fill_kernel = FillScalar;
+
+__attribute__((constructor))
+static void SelectFillKernel(void) {
+#ifdef UTILS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    fill_kernel = FillAvx512;
+  } else if (__builtin_cpu_supports("avx2")) {
+    fill_kernel = FillAvx2;
+  }
+#endif
+}
+
+void GenerateArrayRange(int *array, size_t first, size_t count,
+                        unsigned int seed) {
+  struct GeneratorKey key = MakeKey(seed);
+  // Ядра работают с 32-битным счетчиком, поэтому режем по границам 2^32
+  while (count > 0) {
+    uint64_t index = first;
+    uint64_t block_left = (1ull << 32) - (uint32_t)index;
+    if (block_left > (1ull << 31)) block_left = 1ull << 31;
+    size_t part = count < block_left ? count : (size_t)block_left;
+    fill_kernel(array, (uint32_t)index, (uint32_t)part,
+                KeyForBlock(key, (uint32_t)(index >> 32)));
+    array += part;
+    first += part;
+    count -= part;
+  }
+}
+
+struct ForArgs {
+  RangeFn fn;
+  void *ctx;
+  size_t begin;
+  size_t end;
+};
+
+static void *ForThread(void *args) {
+  struct ForArgs *range = (struct ForArgs *)args;
+  range->fn(range->ctx, range->begin, range->end);
+  return NULL;
+}
+
+void ParallelFor(size_t count, size_t grain, int threads_num, RangeFn fn,
+                 void *ctx) {
+  if (threads_num <= 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    threads_num = cpus > 0 ? (int)cpus : 1;
+  }
+  if (grain > 0 && (size_t)threads_num > count / grain + 1)
+    threads_num = count / grain + 1;
+
+  pthread_t *threads = malloc(threads_num * sizeof(pthread_t));
+  bool *started = malloc(threads_num * sizeof(bool));
+  struct ForArgs *args = malloc(threads_num * sizeof(struct ForArgs));
+  size_t segment = count / threads_num;
+  for (int t = 0; t < threads_num; t++) {
+    args[t].fn = fn;
+    args[t].ctx = ctx;
+    args[t].begin = t * segment;
+    args[t].end = (t == threads_num - 1) ? count : (t + 1) * segment;
   }
+  // Нулевой кусок считает вызывающий поток; если поток не создался,
+  // его часть тоже досчитывается здесь
+  for (int t = 1; t < threads_num; t++) {
+    started[t] = pthread_create(&threads[t], NULL, ForThread, &args[t]) == 0;
+    if (!started[t]) ForThread(&args[t]);
+  }
+  ForThread(&args[0]);
+  for (int t = 1; t < threads_num; t++) {
+    if (started[t]) pthread_join(threads[t], NULL);
+  }
+
+  free(threads);
+  free(started);
+  free(args);
+}
+
+struct GenerateArgs {
+  int *array;
+  unsigned int seed;
+};
+
+static void GenerateSlice(void *ctx, size_t begin, size_t end) {
+  struct GenerateArgs *gen = (struct GenerateArgs *)ctx;
+  GenerateArrayRange(gen->array + begin, begin, end - begin, gen->seed);
+}
+
+void GenerateArray(int *array, size_t array_size, unsigned int seed) {
+  struct GenerateArgs gen = {array, seed};
+  ParallelFor(array_size, PARALLEL_GENERATE_THRESHOLD, 0, GenerateSlice, &gen);
+}
+
+static size_t RoundToHugePage(size_t bytes) {
+  return (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+}
+
+void *AllocateLarge(size_t bytes, bool hugetlb, enum PageKind *kind) {
+  size_t length = RoundToHugePage(bytes > 0 ? bytes : 1);
+#ifdef MAP_HUGETLB
+  if (hugetlb) {
+    void *memory = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory != MAP_FAILED) {
+      if (kind) *kind = PAGES_HUGETLB;
+      return memory;
+    }
+  }
+#endif
+
+  // Берем на 2 МБ больше и обрезаем края, чтобы начало было выровнено
+  char *raw = mmap(NULL, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) return NULL;
+  char *memory = (char *)(((uintptr_t)raw + HUGE_PAGE_SIZE - 1) &
+                          ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+  if (memory > raw) munmap(raw, memory - raw);
+  munmap(memory + length, raw + HUGE_PAGE_SIZE - memory);
+
+  enum PageKind got = PAGES_NORMAL;
+#ifdef MADV_HUGEPAGE
+  if (madvise(memory, length, MADV_HUGEPAGE) == 0) got = PAGES_TRANSPARENT_HUGE;
+#endif
+  if (kind) *kind = got;
+  return memory;
+}
+
+void FreeLarge(void *memory, size_t bytes) {
+  if (memory != NULL) munmap(memory, RoundToHugePage(bytes > 0 ? bytes : 1));
+}
+
+const char *PageKindName(enum PageKind kind) {
+  static const char *names[] = {"normal", "transparent huge", "hugetlb"};
+  return names[kind];
 }
@@ -1,11 +1,39 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
 struct MinMax {
   int min;
   int max;
 };
 
-void GenerateArray(int *array, unsigned int array_size, unsigned int seed);
+// Заполняет массив параллельно (по потоку на ядро); результат зависит
+// только от seed и не зависит от числа потоков
+void GenerateArray(int *array, size_t array_size, unsigned int seed);
+
+// Заполняет array[0, count) элементами [first, first + count) той же
+// последовательности, что и GenerateArray: так каждый воркер может
+// сгенерировать свой кусок сам
+void GenerateArrayRange(int *array, size_t first, size_t count,
+                        unsigned int seed);
+
+// Делит [0, count) поровну между threads_num потоками (<= 0 - по потоку на
+// ядро, но не больше count / grain + 1) и вызывает fn(ctx, begin, end)
+typedef void (*RangeFn)(void *ctx, size_t begin, size_t end);
+void ParallelFor(size_t count, size_t grain, int threads_num, RangeFn fn,
+                 void *ctx);
+
+// Память под большие массивы: mmap, выровненный на 2 МБ, чтобы ядро могло
+// отдать его huge pages. С hugetlb сначала пробуется MAP_HUGETLB (нужны
+// заранее зарезервированные страницы), затем прозрачные huge pages через
+// madvise(MADV_HUGEPAGE), затем обычные страницы. Страницы не трогаются,
+// так что размещение по NUMA-узлам определяет первый записавший поток.
+enum PageKind { PAGES_NORMAL, PAGES_TRANSPARENT_HUGE, PAGES_HUGETLB };
+
+void *AllocateLarge(size_t bytes, bool hugetlb, enum PageKind *kind);
+void FreeLarge(void *memory, size_t bytes);
+const char *PageKindName(enum PageKind kind);
 
 #endif
@@ -0,0 +1,86 @@
+#include "worker_slots.h"
+
+#include <stddef.h>
+#include <sys/mman.h>
+
+struct WorkerSlot *CreateWorkerSlots(int count) {
+  // mmap возвращает обнуленные страницы, так что ready изначально 0
+  void *mem = mmap(NULL, sizeof(struct WorkerSlot) * count,
+                   PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED) return NULL;
+  return (struct WorkerSlot *)mem;
+}
+
+void DestroyWorkerSlots(struct WorkerSlot *slots, int count) {
+  munmap(slots, sizeof(struct WorkerSlot) * count);
+}
+
+void PublishResult(struct WorkerSlot *slot, struct MinMax min_max) {
+  slot->min_max = min_max;
+  atomic_store_explicit(&slot->ready, 1, memory_order_release);
+}
+
+bool ReadResult(struct WorkerSlot *slot, struct MinMax *min_max) {
+  if (!atomic_load_explicit(&slot->ready, memory_order_acquire)) return false;
+  *min_max = slot->min_max;
+  return true;
+}
+
+void PublishProgress(struct WorkerSlot *slot, struct MinMax min_max,
+                     unsigned long scanned) {
+  // Сначала min/max, затем счетчик: прочитавший scanned увидит min/max,
+  // покрывающие как минимум столько элементов
+  atomic_store_explicit(&slot->partial_min, min_max.min, memory_order_relaxed);
+  atomic_store_explicit(&slot->partial_max, min_max.max, memory_order_relaxed);
+  atomic_store_explicit(&slot->scanned, scanned, memory_order_release);
+}
+
+unsigned long ReadProgress(struct WorkerSlot *slot, struct MinMax *min_max) {
+  unsigned long scanned =
+      atomic_load_explicit(&slot->scanned, memory_order_acquire);
+  min_max->min = atomic_load_explicit(&slot->partial_min, memory_order_relaxed);
+  min_max->max = atomic_load_explicit(&slot->partial_max, memory_order_relaxed);
+  return scanned;
+}
+
+void PublishStats(struct WorkerSlot *slot, unsigned long elements,
+                  unsigned long started_ns, unsigned long finished_ns) {
+  atomic_store_explicit(&slot->elements, elements, memory_order_relaxed);
+  atomic_store_explicit(&slot->started_ns, started_ns, memory_order_relaxed);
+  atomic_store_explicit(&slot->finished_ns, finished_ns, memory_order_release);
+}
+
+unsigned long ReadStats(struct WorkerSlot *slot, unsigned long *started_ns,
+                        unsigned long *finished_ns) {
+  *finished_ns = atomic_load_explicit(&slot->finished_ns, memory_order_acquire);
+  *started_ns = atomic_load_explicit(&slot->started_ns, memory_order_relaxed);
+  return atomic_load_explicit(&slot->elements, memory_order_relaxed);
+}
+
+struct ChunkQueue *CreateChunkQueue(size_t array_size, size_t chunk_size) {
+  void *mem = mmap(NULL, sizeof(struct ChunkQueue), PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED) return NULL;
+
+  struct ChunkQueue *queue = (struct ChunkQueue *)mem;
+  atomic_init(&queue->next_chunk, 0);
+  queue->chunk_size = chunk_size;
+  queue->array_size = array_size;
+  queue->chunk_count = array_size / chunk_size + (array_size % chunk_size != 0);
+  return queue;
+}
+
+void DestroyChunkQueue(struct ChunkQueue *queue) {
+  munmap(queue, sizeof(struct ChunkQueue));
+}
+
+bool ClaimChunk(struct ChunkQueue *queue, size_t *begin, size_t *end) {
+  size_t chunk =
+      atomic_fetch_add_explicit(&queue->next_chunk, 1, memory_order_relaxed);
+  if (chunk >= queue->chunk_count) return false;
+
+  *begin = chunk * queue->chunk_size;
+  *end = *begin + queue->chunk_size;
+  if (*end > queue->array_size || *end < *begin) *end = queue->array_size;
+  return true;
+}
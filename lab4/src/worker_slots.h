@@ -0,0 +1,65 @@
+#ifndef WORKER_SLOTS_H
+#define WORKER_SLOTS_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utils.h"
+
+#define CACHE_LINE_SIZE 64
+
+// Слот результата одного воркера в общей памяти. Каждый слот занимает
+// свою кэш-линию, чтобы воркеры не мешали друг другу (false sharing).
+struct WorkerSlot {
+  struct MinMax min_max;
+  atomic_int ready;
+  // Текущий прогресс: min/max по уже просмотренным элементам и их число.
+  // Переживает SIGKILL воркера, поэтому по таймауту работа не теряется.
+  atomic_int partial_min;
+  atomic_int partial_max;
+  atomic_ulong scanned;
+  // Сколько элементов воркер просмотрел, когда начал и закончил
+  // (CLOCK_MONOTONIC, нс)
+  atomic_ulong elements;
+  atomic_ulong started_ns;
+  atomic_ulong finished_ns;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+// Общая очередь кусков массива для динамического распределения работы:
+// воркеры забирают куски атомарным счетчиком, пока они не закончатся
+struct ChunkQueue {
+  atomic_ulong next_chunk;
+  size_t chunk_count;
+  size_t chunk_size;
+  size_t array_size;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+// Анонимное MAP_SHARED отображение на count слотов, видимое после fork()
+struct WorkerSlot *CreateWorkerSlots(int count);
+void DestroyWorkerSlots(struct WorkerSlot *slots, int count);
+
+// Запись результата воркером и чтение родителем без системных вызовов
+void PublishResult(struct WorkerSlot *slot, struct MinMax min_max);
+bool ReadResult(struct WorkerSlot *slot, struct MinMax *min_max);
+
+// Промежуточный прогресс воркера; ReadProgress возвращает число элементов,
+// которые гарантированно учтены в *min_max
+void PublishProgress(struct WorkerSlot *slot, struct MinMax min_max,
+                     unsigned long scanned);
+unsigned long ReadProgress(struct WorkerSlot *slot, struct MinMax *min_max);
+
+// Итоговая статистика воркера для разбивки по NUMA-узлам и шкалы времени
+void PublishStats(struct WorkerSlot *slot, unsigned long elements,
+                  unsigned long started_ns, unsigned long finished_ns);
+// Возвращает число элементов; finished_ns == 0 - воркер не закончил
+unsigned long ReadStats(struct WorkerSlot *slot, unsigned long *started_ns,
+                        unsigned long *finished_ns);
+
+struct ChunkQueue *CreateChunkQueue(size_t array_size, size_t chunk_size);
+void DestroyChunkQueue(struct ChunkQueue *queue);
+
+// Забирает следующий кусок [*begin, *end); false, если куски закончились
+bool ClaimChunk(struct ChunkQueue *queue, size_t *begin, size_t *end);
+
+#endif
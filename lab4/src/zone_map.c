@@ -0,0 +1,116 @@
+#include "zone_map.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "find_min_max.h"
+
+// Зон меньше этого числа не стоит строить в нескольких потоках
+#define ZONE_BUILD_GRAIN 64
+
+struct ZoneBuild {
+  struct ZoneMap *map;
+  int *array;
+  size_t size;
+};
+
+static void BuildZones(void *ctx, size_t begin, size_t end) {
+  struct ZoneBuild *build = (struct ZoneBuild *)ctx;
+  size_t zone_size = build->map->zone_size;
+  for (size_t z = begin; z < end; z++) {
+    size_t first = z * zone_size;
+    size_t last =
+        build->size - first > zone_size ? first + zone_size : build->size;
+    struct MinMax min_max = GetMinMax(build->array, first, last);
+    build->map->owned[z].min = min_max.min;
+    build->map->owned[z].max = min_max.max;
+    build->map->owned[z].count = last - first;
+    build->map->owned[z].reserved = 0;
+  }
+}
+
+int BuildZoneMap(struct ZoneMap *map, int *array, size_t size,
+                 unsigned int zone_size, int threads_num) {
+  // Число зон хранится в 32 битах, как и в заголовке файла набора данных
+  if (zone_size == 0 || size / zone_size >= UINT32_MAX) return -1;
+  map->zone_size = zone_size;
+  map->zone_count = size / zone_size + (size % zone_size != 0);
+  map->owned = malloc(map->zone_count * sizeof(struct ZoneSummary));
+  if (map->owned == NULL) return -1;
+  map->zones = map->owned;
+
+  struct ZoneBuild build = {map, array, size};
+  ParallelFor(map->zone_count, ZONE_BUILD_GRAIN, threads_num, BuildZones,
+              &build);
+  return 0;
+}
+
+int ZoneMapFromDataset(struct ZoneMap *map, const struct Dataset *dataset) {
+  if (dataset->zones == NULL) return -1;
+  map->zone_size = dataset->zone_size;
+  map->zone_count = dataset->zone_count;
+  map->zones = dataset->zones;
+  map->owned = NULL;
+  return 0;
+}
+
+void FreeZoneMap(struct ZoneMap *map) {
+  free(map->owned);
+  map->owned = NULL;
+  map->zones = NULL;
+}
+
+static struct MinMax FilteredMinMax(int *array, size_t begin, size_t end,
+                                    const struct ValueFilter *filter) {
+  if (filter == NULL) return GetMinMax(array, begin, end);
+
+  struct MinMax min_max = {INT_MAX, INT_MIN};
+  for (size_t i = begin; i < end; i++) {
+    int value = array[i];
+    bool match = value >= filter->lo && value <= filter->hi;
+    min_max.min = match && value < min_max.min ? value : min_max.min;
+    min_max.max = match && value > min_max.max ? value : min_max.max;
+  }
+  return min_max;
+}
+
+static void Merge(struct MinMax *acc, struct MinMax part) {
+  if (part.min < acc->min) acc->min = part.min;
+  if (part.max > acc->max) acc->max = part.max;
+}
+
+struct MinMax ZoneMinMax(const struct ZoneMap *map, int *array,
+                         size_t begin, size_t end,
+                         const struct ValueFilter *filter) {
+  if (map == NULL || map->zones == NULL || begin >= end) {
+    return FilteredMinMax(array, begin, end, filter);
+  }
+
+  size_t zone_size = map->zone_size;
+  size_t first = begin / zone_size + (begin % zone_size != 0);
+  size_t last = end / zone_size;
+  if (first >= last) return FilteredMinMax(array, begin, end, filter);
+
+  // Неполные зоны на краях сканируем, полные - по сводкам
+  struct MinMax result = FilteredMinMax(array, begin, first * zone_size, filter);
+  Merge(&result, FilteredMinMax(array, last * zone_size, end, filter));
+
+  for (size_t z = first; z < last; z++) {
+    const struct ZoneSummary *zone = &map->zones[z];
+    struct MinMax summary = {zone->min, zone->max};
+    if (filter == NULL) {
+      Merge(&result, summary);
+    } else if (zone->max < filter->lo || zone->min > filter->hi) {
+      continue;  // ни один элемент зоны не проходит фильтр
+    } else if (zone->min >= filter->lo && zone->max <= filter->hi) {
+      Merge(&result, summary);  // все элементы зоны проходят фильтр
+    } else if (zone->min >= result.min && zone->max <= result.max) {
+      continue;  // зона не может улучшить уже найденные min и max
+    } else {
+      Merge(&result, FilteredMinMax(array, z * zone_size,
+                                    z * zone_size + zone->count, filter));
+    }
+  }
+  return result;
+}
@@ -0,0 +1,41 @@
+#ifndef ZONE_MAP_H
+#define ZONE_MAP_H
+
+#include <stdbool.h>
+
+#include "dataset.h"
+#include "utils.h"
+
+#define DEFAULT_ZONE_SIZE 4096
+
+// Карта зон: min/max/count каждого блока из zone_size элементов. Сканер
+// пропускает зоны, которые не могут повлиять на ответ, и берет готовую
+// сводку для зон, попавших в запрос целиком.
+struct ZoneMap {
+  unsigned int zone_size;
+  unsigned int zone_count;
+  const struct ZoneSummary *zones;
+  // Выделенная память или NULL, если сводки лежат в отображенном файле
+  struct ZoneSummary *owned;
+};
+
+// Учитываются только элементы со значениями из [lo, hi]
+struct ValueFilter {
+  int lo;
+  int hi;
+};
+
+// Строит карту параллельно (threads_num <= 0 - по потоку на ядро)
+int BuildZoneMap(struct ZoneMap *map, int *array, size_t size,
+                 unsigned int zone_size, int threads_num);
+// Берет сводки из файла набора данных; -1, если их там нет
+int ZoneMapFromDataset(struct ZoneMap *map, const struct Dataset *dataset);
+void FreeZoneMap(struct ZoneMap *map);
+
+// GetMinMax по [begin, end) с учетом карты зон и фильтра; map и filter
+// могут быть NULL. Если подходящих элементов нет, min > max.
+struct MinMax ZoneMinMax(const struct ZoneMap *map, int *array,
+                         size_t begin, size_t end,
+                         const struct ValueFilter *filter);
+
+#endif